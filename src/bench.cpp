@@ -0,0 +1,586 @@
+#include "ExpGen.hpp"
+#include "Interpreter.hpp"
+#include "Lexer.hpp"
+#include "Node.hpp"
+#include "Parser.hpp"
+#include "ProgramCache.hpp"
+#include "Scanner.hpp"
+#include "TokenBuffer.hpp"
+#include "Worksheet.hpp"
+#include "tokens.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+#if __has_include(<sys/resource.h>)
+#include <sys/resource.h>
+#endif
+
+namespace {
+/*bytes held by operator new, each allocation records its size in front of it*/
+std::atomic<std::size_t> live_bytes{0};
+const constexpr std::size_t size_header{alignof(std::max_align_t)};
+} // namespace
+
+void *operator new(std::size_t size) {
+  auto *memory{static_cast<char *>(std::malloc(size + size_header))};
+  if (!memory) {
+    throw std::bad_alloc{};
+  }
+  *reinterpret_cast<std::size_t *>(memory) = size;
+  live_bytes += size;
+  return memory + size_header;
+}
+
+void operator delete(void *pointer) noexcept {
+  if (!pointer) {
+    return;
+  }
+  auto *memory{static_cast<char *>(pointer) - size_header};
+  live_bytes -= *reinterpret_cast<std::size_t *>(memory);
+  std::free(memory);
+}
+
+void operator delete(void *pointer, [[maybe_unused]] std::size_t size) noexcept {
+  operator delete(pointer);
+}
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+const constexpr std::size_t corpus_programs{2000};
+const constexpr std::size_t repetitions{20};
+
+/**
+ * @brief
+ * concatenate the source of many generated programs
+ * @param programs number of programs to generate
+ * @return std::string
+ */
+std::string makeCorpus(std::size_t programs) {
+  std::string corpus{};
+  for (std::size_t i = 0; i < programs; ++i) {
+    ExpGen exp_gen{};
+    corpus.append(exp_gen.getStatements()->toString(true));
+  }
+  return corpus;
+}
+
+/**
+ * @brief
+ * indent every line of the corpus, typical of hand formatted scripts with long whitespace runs
+ * @param corpus
+ * @return std::string
+ */
+std::string indentCorpus(std::string_view corpus) {
+  const std::string indent(48, ' ');
+  std::string out{indent};
+  for (char c : corpus) {
+    out.push_back(c);
+    if (c == '\n') {
+      out.append(indent);
+    }
+  }
+  return out;
+}
+
+double secondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void benchLexer(std::string_view corpus, const Scanner &scanner) {
+  std::size_t tokens{};
+  auto start{Clock::now()};
+  for (std::size_t i = 0; i < repetitions; ++i) {
+    Lexer lexer{corpus, {}, scanner};
+    while (lexer.getCurrentToken().m_token != Token::EOF_sym) {
+      ++tokens;
+      lexer.advance();
+    }
+  }
+  auto seconds{secondsSince(start)};
+  std::cout << "lexer (" << scanner.m_name << "): " << tokens << " tokens in " << seconds << " s, "
+            << static_cast<double>(tokens) / seconds / 1e6 << " Mtokens/s\n";
+}
+
+void printThroughput(std::string_view name, std::string_view corpus, double seconds) {
+  std::cout << name << ": " << static_cast<double>(corpus.size() * repetitions) / seconds / 1e6
+            << " MB/s\n";
+}
+
+/*pre-tokenizing first lets lexing and parsing be timed apart*/
+void benchParser(std::string_view corpus) {
+  double tokenize_seconds{};
+  double parse_seconds{};
+  std::size_t tokens{};
+  for (std::size_t i = 0; i < repetitions; ++i) {
+    auto start{Clock::now()};
+    TokenBuffer buffer{Lexer{corpus}.tokenize()};
+    tokenize_seconds += secondsSince(start);
+    tokens += buffer.size();
+
+    start = Clock::now();
+    Parser parser{};
+    auto program{parser.genAST(std::move(buffer))};
+    parse_seconds += secondsSince(start);
+  }
+  std::cout << "tokenize: " << static_cast<double>(tokens) / tokenize_seconds / 1e6
+            << " Mtokens/s\n";
+  printThroughput("tokenize", corpus, tokenize_seconds);
+  printThroughput("parse from tokens", corpus, parse_seconds);
+  printThroughput("tokenize and parse", corpus, tokenize_seconds + parse_seconds);
+}
+
+/*validation walks the same grammar as a full parse without allocating nodes*/
+void benchValidate(std::string_view corpus) {
+  auto start{Clock::now()};
+  for (std::size_t i = 0; i < repetitions; ++i) {
+    Parser parser{};
+    auto program{parser.genAST(corpus)};
+  }
+  const auto parse_seconds{secondsSince(start)};
+
+  start = Clock::now();
+  for (std::size_t i = 0; i < repetitions; ++i) {
+    Parser parser{};
+    parser.validate(corpus);
+  }
+  const auto validate_seconds{secondsSince(start)};
+  printThroughput("full parse", corpus, parse_seconds);
+  printThroughput("validate", corpus, validate_seconds);
+  std::cout << "validate is " << parse_seconds / validate_seconds << "x a full parse\n";
+}
+
+void benchParallel(std::string_view corpus) {
+  const std::size_t threads{std::max(std::thread::hardware_concurrency(), 1u)};
+  for (std::size_t count = 1; count <= threads; count *= 2) {
+    auto start{Clock::now()};
+    for (std::size_t i = 0; i < repetitions; ++i) {
+      auto program{Parser::genASTParallel(corpus, count)};
+    }
+    const auto seconds{secondsSince(start)};
+    printThroughput("parallel parse on " + std::to_string(count) + " threads", corpus, seconds);
+  }
+}
+
+/*a structural fingerprint against hashing the printed program*/
+void benchFingerprint(std::string_view corpus) {
+  Parser parser{};
+  const auto program{parser.genAST(corpus)};
+  std::size_t sink{};
+  auto start{Clock::now()};
+  for (std::size_t i = 0; i < repetitions; ++i) {
+    sink += std::hash<std::string>{}(program->toString(false));
+  }
+  printThroughput("hash of toString", corpus, secondsSince(start));
+  start = Clock::now();
+  for (std::size_t i = 0; i < repetitions; ++i) {
+    sink += program->getFingerprint().m_low;
+  }
+  printThroughput("fingerprint", corpus, secondsSince(start));
+  start = Clock::now();
+  for (std::size_t i = 0; i < repetitions; ++i) {
+    sink += program->getFingerprint(true).m_low;
+  }
+  printThroughput("commutative fingerprint", corpus, secondsSince(start));
+  std::cout << "(" << sink % 10 << ")\n";
+}
+
+/*
+one statement nesting a generated expression per level, the printed text is about as long at
+every depth so the time spent printing each byte shows whether printing is linear
+*/
+void benchPrint() {
+  for (std::size_t depth : {100, 1000, 10000, 100000}) {
+    ExpGen exp_gen{};
+    std::string source{};
+    for (std::size_t i = 0; i < depth; ++i) {
+      source.append(exp_gen.genArithmetic()->toString(true)).append(" + (");
+    }
+    source.append("1").append(depth, ')').append(";");
+    const auto copies{std::max<std::size_t>(100000 / depth, 1)};
+    std::string script{};
+    for (std::size_t i = 0; i < copies; ++i) {
+      script.append(source);
+    }
+    Parser parser{};
+    const auto program{parser.genAST(script)};
+
+    auto start{Clock::now()};
+    std::size_t bytes{};
+    for (std::size_t i = 0; i < repetitions; ++i) {
+      bytes += program->toString(true).size();
+    }
+    const auto string_seconds{secondsSince(start)};
+    start = Clock::now();
+    std::ostringstream stream{};
+    for (std::size_t i = 0; i < repetitions; ++i) {
+      program->print(stream, true);
+    }
+    const auto stream_seconds{secondsSince(start)};
+    std::cout << "print depth " << depth << ": "
+              << static_cast<double>(bytes) / string_seconds / 1e6 << " MB/s to a string, "
+              << static_cast<double>(bytes) / stream_seconds / 1e6 << " MB/s to a stream\n";
+  }
+}
+
+/*an arena frees every node of a program at once instead of one at a time*/
+void benchArena() {
+  ExpGen exp_gen{};
+  const std::string source{exp_gen.getStatements(10000)->toString(true)};
+  for (auto allocation : {NodeAllocation::heap, NodeAllocation::arena}) {
+    double parse_seconds{};
+    double destroy_seconds{};
+    for (std::size_t i = 0; i < repetitions; ++i) {
+      auto start{Clock::now()};
+      Parser parser{allocation};
+      auto program{parser.genAST(source)};
+      parse_seconds += secondsSince(start);
+
+      start = Clock::now();
+      program.reset();
+      destroy_seconds += secondsSince(start);
+    }
+    std::cout << (allocation == NodeAllocation::heap ? "heap" : "arena")
+              << " nodes, 10000 statements: parse " << parse_seconds / repetitions * 1e3
+              << " ms, destroy " << destroy_seconds / repetitions * 1e3 << " ms\n";
+  }
+}
+
+/*
+a script that always runs, generated programs nearly always stop at a runtime error
+each statement reads the variables made before it so nothing can be skipped
+*/
+std::string makeEvalScript(std::size_t statements) {
+  std::string script{"var v0 = 0.5;\n"};
+  for (std::size_t i = 1; i < statements; ++i) {
+    const auto last{"v" + std::to_string(i - 1)};
+    const auto next{"v" + std::to_string(i)};
+    script.append("var " + next + " = sin(" + last + ") * 0.9 + cos(" + last + " * 0.5) - " +
+                  last + " * 0.1 + (" + last + " - 1) * (" + last + " + 1) * 0.01;\n");
+    script.append(next + " greater_than 0 and not (" + next + " equal_to 1) or " + last +
+                  " less_than -1;\n");
+    script.append("(" + next + " + " + last + ") * (" + next + " - 2) - sqrt(" + next + " * " +
+                  next + " + 1) + " + next + " % 0.75;\n");
+  }
+  return script;
+}
+
+/*running a parsed program again and again, as a worksheet does*/
+void benchEval() {
+  const std::string script{makeEvalScript(10000)};
+  auto program{Parser{}.genAST(script)};
+  std::size_t outputs{};
+  auto start{Clock::now()};
+  for (std::size_t i = 0; i < repetitions * 10; ++i) {
+    SymbolTable symbol_table{};
+    outputs += program->eval(symbol_table).size();
+  }
+  const auto seconds{secondsSince(start)};
+  std::cout << "eval of " << script.size() << " bytes: " << seconds / (repetitions * 10) * 1e3
+            << " ms per run (" << outputs << " bytes output)\n";
+}
+
+/*statements full of constant subtrees and identities, as scripts written by hand or generated are*/
+std::string makeFoldScript(std::size_t statements) {
+  std::string script{"var f0 = 0.5;\n"};
+  for (std::size_t i = 1; i < statements; ++i) {
+    const auto last{"f" + std::to_string(i - 1)};
+    const auto next{"f" + std::to_string(i)};
+    script.append("var " + next + " = (sin(3.1) * 2.5 + Int(4.7)) * 0.2 * " + last +
+                  " * 1 - 0.25 * (" + last + " - 0) + 1;\n");
+    script.append(next + " greater_than 0 and (2 less_than 3) or not (not (" + next +
+                  " equal_to 1));\n");
+    script.append("(" + next + " + -0) * (1 + 2 ^ 3) / (4 - 1.5) + -(-" + last + ");\n");
+  }
+  return script;
+}
+
+/*polynomials in a variable that changes every statement, as user formulas often are*/
+std::string makeReduceScript(std::size_t statements) {
+  std::string script{"var x = 0.5;\n"};
+  for (std::size_t i = 1; i < statements; ++i) {
+    script.append("3 * x * x * x - 2 * x * x + x / 4 - 1.5;\n");
+    script.append("(x * x + 1) / 8 + x * x % 2 + Int(Int(x * 4) / 2) + Int(x) ^ 1;\n");
+    script.append("x = x * x / 16 + x / 2 + 0.25;\n");
+  }
+  return script;
+}
+
+/*
+a script repeating distances to a point that moves every few statements, as formulas written out
+in full tend to
+*/
+std::string makeReuseScript(std::size_t statements) {
+  const std::string distance{"sqrt((x - 1.5) * (x - 1.5) + (y - 2.5) * (y - 2.5))"};
+  std::string script{"var x = 0.5; var y = 0.25;\n"};
+  for (std::size_t i = 1; i < statements; ++i) {
+    const auto next{"d" + std::to_string(i)};
+    script.append("var " + next + " = " + distance + " * 2 + " + distance + " / 3;\n");
+    script.append("(x - 1.5) * (x - 1.5) / (" + distance + " + 1) less_than " + next + ";\n");
+    script.append("cos(" + distance + ") * sin(" + distance + ") + " + next + ";\n");
+    script.append("x = x + 0.001; y = " + distance + " * 0.5;\n");
+  }
+  return script;
+}
+
+/*
+what one optimization level removes from generated programs, and a script with much for it to do
+run before and after it. Levels past fold are measured against a folded program, as they would run
+*/
+void benchOptimization(std::string_view name, Optimization level, std::string_view corpus,
+                       const std::string &script) {
+  const auto unit{level == Optimization::fold ? "nodes" : "instructions"};
+  const auto before{level == Optimization::fold ? "unoptimized" : "folded"};
+
+  auto parsed{Parser{}.genAST(corpus)};
+  if (level != Optimization::fold) {
+    parsed->optimize(Optimization::fold);
+  }
+  const auto removed{parsed->optimize(level)};
+  std::cout << name << " of corpus: " << removed << " " << unit << " removed, "
+            << static_cast<double>(removed) / corpus_programs << " per program\n";
+
+  auto program{Parser{}.genAST(script)};
+  auto run = [&program] {
+    auto start{Clock::now()};
+    for (std::size_t i = 0; i < repetitions * 10; ++i) {
+      SymbolTable symbol_table{};
+      program->eval(symbol_table);
+    }
+    return secondsSince(start) / (repetitions * 10);
+  };
+  if (level != Optimization::fold) {
+    program->optimize(Optimization::fold);
+  }
+  const auto unoptimized{run()};
+  const auto script_removed{program->optimize(level)};
+  const auto optimized{run()};
+  std::cout << name << " of " << script.size() << " bytes: " << script_removed << " " << unit
+            << " removed, eval " << unoptimized * 1e3 << " ms " << before << ", "
+            << optimized * 1e3 << " ms after " << name << " (" << unoptimized / optimized
+            << "x)\n";
+}
+
+/*
+small requests as a service would get them, one in five malformed or failing at runtime
+each error is a different kind so no one path of the parser or the operations dominates
+*/
+std::vector<std::string> makeRequests(std::size_t count) {
+  const std::string_view errors[]{
+      "var x = 2; log(x - 3);", "var x = 2; x / (x - x);", "var x = 2; x + * 2;",
+      "var x = 2; y * 2;",      "var x = 2; x # 2;",       "var x = 2; (x + 1;",
+  };
+  std::vector<std::string> requests{};
+  for (std::size_t i = 0; i < count; ++i) {
+    if (i % 5 == 0) {
+      requests.emplace_back(errors[i / 5 % std::size(errors)]);
+      continue;
+    }
+    const auto x{std::to_string(static_cast<double>(i % 97) * 0.1)};
+    requests.push_back("var x = " + x + "; sin(x) * 2 + sqrt(x + 1); x greater_than 1 and x " +
+                       "less_than 5;");
+  }
+  return requests;
+}
+
+/*time each request on a fresh interpreter then print the median and tail*/
+template <typename Run>
+void printLatency(std::string_view name, const std::vector<std::string> &requests, Run run) {
+  std::vector<double> latencies{};
+  latencies.reserve(requests.size());
+  std::size_t sink{};
+  for (std::size_t repetition = 0; repetition < repetitions; ++repetition) {
+    for (const auto &request : requests) {
+      Interpreter interpreter{};
+      const auto start{Clock::now()};
+      sink += run(interpreter, request);
+      latencies.push_back(secondsSince(start) * 1e6);
+    }
+  }
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile{[&latencies](double p) {
+    return latencies[static_cast<std::size_t>(p * static_cast<double>(latencies.size() - 1))];
+  }};
+  std::cout << name << ": p50 " << percentile(0.5) << " us, p99 " << percentile(0.99)
+            << " us, p99.9 " << percentile(0.999) << " us (" << sink << " bytes output)\n";
+}
+
+/*the throwing API against the one returning errors on a mix with many errors*/
+void benchErrors() {
+  const auto requests{makeRequests(5000)};
+  printLatency("evaluate", requests, [](Interpreter &interpreter, std::string_view request) {
+    try {
+      return interpreter.evaluate(request).size();
+    } catch (const std::exception &e) {
+      return std::string_view{e.what()}.size();
+    }
+  });
+  printLatency("tryEvaluate", requests, [](Interpreter &interpreter, std::string_view request) {
+    const auto result{interpreter.tryEvaluate(request)};
+    return result ? result.getValue().size()
+                  : static_cast<std::size_t>(result.getError().getCode());
+  });
+  printLatency("tryEvaluate with messages", requests,
+               [](Interpreter &interpreter, std::string_view request) {
+                 const auto result{interpreter.tryEvaluate(request)};
+                 return result ? result.getValue().size() : result.getError().getMessage().size();
+               });
+}
+
+/*the same requests parsed every time against looked up in a cache after their first parse*/
+void benchCache() {
+  const auto requests{makeRequests(5000)};
+  auto run{[](ProgramCache *cache) {
+    return [cache](Interpreter &interpreter, std::string_view request) {
+      interpreter.setProgramCache(cache);
+      const auto result{interpreter.tryEvaluate(request)};
+      return result ? result.getValue().size() : result.getError().getDescription().size();
+    };
+  }};
+  printLatency("uncached", requests, run(nullptr));
+  ProgramCache cache{};
+  printLatency("cached", requests, run(&cache));
+  const auto stats{cache.getStats()};
+  std::cout << "cache: " << stats.m_hits << " hits, " << stats.m_misses << " misses, "
+            << stats.m_programs << " programs in " << stats.m_bytes << " bytes\n";
+}
+
+/*peak resident set of the process in KiB, 0 where it cannot be read*/
+long peakResidentKiB() {
+#if __has_include(<sys/resource.h>)
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+#else
+  return 0;
+#endif
+}
+
+/*every operand, operator and statement of a program is one node, brackets make none*/
+std::size_t countNodes(const TokenBuffer &tokens) {
+  std::size_t nodes{};
+  for (std::size_t i = 0; i < tokens.size(); ++i) {
+    switch (tokens.getToken(i)) {
+    case Token::Lp:
+    case Token::Rp:
+    case Token::Var:
+    case Token::EOF_sym:
+      break;
+    case Token::Assign:
+      // the assigned name is the node of an assignment so it does not print
+      --nodes;
+      break;
+    default:
+      ++nodes;
+      break;
+    }
+  }
+  return nodes;
+}
+
+/*what a large program costs to hold in memory*/
+void benchMemory() {
+  const std::string source{makeCorpus(10000)};
+  const std::size_t nodes{countNodes(Lexer{source}.tokenize())};
+  const long peak_before{peakResidentKiB()};
+  // heap nodes are allocated one at a time so every byte they hold is counted
+  TokenBuffer tokens{Lexer{source}.tokenize()};
+  const std::size_t before{live_bytes};
+  Parser parser{};
+  auto program{parser.genAST(std::move(tokens))};
+  const std::size_t bytes{live_bytes - before};
+  std::cout << "program of " << nodes << " nodes: " << bytes / 1024 << " KiB, "
+            << static_cast<double>(bytes) / static_cast<double>(nodes) << " bytes per node\n";
+  std::cout << "peak RSS: " << peak_before << " KiB generating the source, "
+            << peakResidentKiB() << " KiB after parsing it\n";
+}
+
+/*an edit to one line should cost the same however long the worksheet is*/
+void benchWorksheet() {
+  for (std::size_t lines : {1000, 10000, 100000}) {
+    Worksheet worksheet{};
+    worksheet.replaceLines(0, 0, std::vector<std::string>(lines, "var_a * (2 + 3) - 1"));
+    const std::size_t edits{10000};
+    auto start{Clock::now()};
+    for (std::size_t i = 0; i < edits; ++i) {
+      worksheet.replaceLines(lines / 2, 1, {i % 2 ? "var_a * (2 + 3) - " : "var_a * (2 + 3) - 1"});
+    }
+    std::cout << "worksheet of " << lines << " lines: " << secondsSince(start) / edits * 1e6
+              << " us per edit\n";
+  }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::string_view mode{argc > 1 ? argv[1] : "all"};
+  if (mode == "memory") {
+    // run alone so the peak resident set is the program's and not the corpus's
+    benchMemory();
+    return 0;
+  }
+  const std::string corpus{makeCorpus(corpus_programs)};
+  std::cout << "corpus: " << corpus.size() << " bytes from " << corpus_programs
+            << " generated programs\n";
+
+  if (mode == "lexer" || mode == "all") {
+    benchLexer(corpus, getScalarScanner());
+    benchLexer(corpus, getScanner());
+    const std::string indented{indentCorpus(corpus)};
+    std::cout << "indented corpus: " << indented.size() << " bytes\n";
+    benchLexer(indented, getScalarScanner());
+    benchLexer(indented, getScanner());
+  }
+  if (mode == "parser" || mode == "all") {
+    benchParser(corpus);
+  }
+  if (mode == "validate" || mode == "all") {
+    benchValidate(corpus);
+  }
+  if (mode == "parallel" || mode == "all") {
+    benchParallel(corpus);
+  }
+  if (mode == "fingerprint" || mode == "all") {
+    benchFingerprint(corpus);
+  }
+  if (mode == "print" || mode == "all") {
+    benchPrint();
+  }
+  if (mode == "arena" || mode == "all") {
+    benchArena();
+  }
+  if (mode == "eval" || mode == "all") {
+    benchEval();
+  }
+  if (mode == "fold" || mode == "all") {
+    benchOptimization("fold", Optimization::fold, corpus, makeFoldScript(10000));
+  }
+  if (mode == "reduce" || mode == "all") {
+    benchOptimization("reduce", Optimization::reduce, corpus, makeReduceScript(10000));
+  }
+  if (mode == "reuse" || mode == "all") {
+    benchOptimization("reuse", Optimization::reuse, corpus, makeReuseScript(5000));
+  }
+  if (mode == "errors" || mode == "all") {
+    benchErrors();
+  }
+  if (mode == "cache" || mode == "all") {
+    benchCache();
+  }
+  if (mode == "worksheet" || mode == "all") {
+    benchWorksheet();
+  }
+  return 0;
+}
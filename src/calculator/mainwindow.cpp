@@ -1,5 +1,11 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include <QStatusBar>
+#include <QTextBlock>
+#include <QTextDocument>
+#include <algorithm>
+#include <string>
+#include <vector>
 
 MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWindow) {
   ui->setupUi(this);
@@ -7,6 +13,11 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
   const QStringList headers{"Variable", "Type", "Value"};
   ui->table->setHorizontalHeaderLabels(headers);
   update_table();
+
+  // check syntax as the user types, only the edited lines are parsed again
+  worksheet.setText(ui->display->toPlainText().toStdString());
+  connect(ui->display->document(), &QTextDocument::contentsChange, this,
+          &MainWindow::display_contents_changed);
 }
 
 MainWindow::~MainWindow() { delete ui; }
@@ -222,28 +233,13 @@ void MainWindow::on_evaulate_clicked()
 
 
   auto raw_input = ui->display->toPlainText();
-  ui->display->selectAll();
-  ui->display->textCursor().removeSelectedText();
 
   qDebug() << raw_input << "\n";
 
-  // add semi colon at end of each string
-  std::string input{raw_input.toStdString()};
-  auto it = input.begin();
-  while((it = std::find(it, input.end(), '\n')) != input.end()){
-    it = input.insert(it, ';') +2;
-  }
-  if(!input.ends_with(';')){
-    input.push_back(';');
-  }
-  qDebug() << input << "\n";
-
-  ui->display->selectAll();
-  ui->display->textCursor().insertText(QString(input.c_str()));
-
+  // the worksheet already holds every line parsed, a missing semi colon ends each line
   std::string output{""};
   try{
-    output += interpreter.evaluate(input);
+    output += interpreter.evaluate(worksheet);
   }
   catch(const std::exception &e){
     output += e.what();
@@ -257,6 +253,54 @@ void MainWindow::on_evaulate_clicked()
 
 }
 
+void MainWindow::display_contents_changed(int position, int removed, int added)
+{
+
+  Q_UNUSED(removed);
+  const QTextDocument *document{ui->display->document()};
+  const QTextBlock first_block{document->findBlock(position)};
+  QTextBlock last_block{document->findBlock(position + added)};
+  if(!last_block.isValid()){
+    last_block = document->lastBlock();
+  }
+
+  // lines the edit added or removed are the difference in the line count
+  const int first{first_block.blockNumber()};
+  const int count{last_block.blockNumber() - first + 1};
+  const int old_count{static_cast<int>(worksheet.getLineCount())};
+  const int replaced{std::max(0, count - (document->blockCount() - old_count))};
+
+  std::vector<std::string> lines{};
+  for(auto block = first_block; block.isValid() && block.blockNumber() <= last_block.blockNumber(); block = block.next()){
+    lines.push_back(block.text().toStdString());
+  }
+  worksheet.replaceLines(first, replaced, lines);
+  show_diagnostics(first, count);
+
+}
+
+void MainWindow::show_diagnostics(int first, int count)
+{
+
+  if(worksheet.getErrorCount() == 0){
+    statusBar()->clearMessage();
+    return;
+  }
+
+  // prefer an error on the lines just edited
+  auto diagnostics = worksheet.getDiagnostics(first, count);
+  if(diagnostics.empty()){
+    statusBar()->showMessage(QString::number(worksheet.getErrorCount()) + " lines with errors");
+    return;
+  }
+  const auto &error = diagnostics.front();
+  statusBar()->showMessage(QString("Line: %1 Postion: %2 %3")
+                               .arg(error.m_line)
+                               .arg(error.m_postion)
+                               .arg(QString::fromStdString(error.m_message)));
+
+}
+
 void MainWindow::update_table(){
   auto symbol_table = interpreter.getSymbolTable();
 
@@ -3,6 +3,7 @@
 
 #include <QMainWindow>
 #include "Interpreter.hpp"
+#include "Worksheet.hpp"
 
 template<class... Ts>
 struct overloads : Ts... { using Ts::operator()...; };
@@ -59,10 +60,14 @@ private slots:
 
   void on_evaulate_clicked();
 
+  void display_contents_changed(int position, int removed, int added);
+
 private:
   Ui::MainWindow *ui;
   Interpreter interpreter{};
+  Worksheet worksheet{};
   void update_table();
+  void show_diagnostics(int first, int count);
 };
 
 #endif
@@ -1,118 +1,109 @@
 #include "AST.hpp"
+#include "Bytecode.hpp"
 #include "Errors.hpp"
+#include "Operations.hpp"
 #include "common.hpp"
-#include <cfenv>
-#include <cmath>
-#include <iomanip>
-#include <sstream>
+#include <bit>
+#include <charconv>
 #include <utility>
 
-#if !(math_errhandling & MATH_ERREXCEPT)
-#error "no floating point exceptions"
-#endif
+namespace {
 
-Variable::Variable(TokenData &&token) : m_token(std::move(token)) {
-  if (m_token.getToken() != Token::Id) {
-    throw SyntaxError{"Not an identifier", m_token.getLocation()};
-  }
+/*nodes are labelled with the opcode they compile to, as Bytecode::getFingerprint labels them*/
+NodeLabel makeLabel(Opcode op, std::uint64_t value) {
+  return {static_cast<std::uint64_t>(op), value, false, false};
 }
 
-std::string Variable::toString([[maybe_unused]] const bool braces) const {
-  return {" " + m_token.getText() + " "};
+NodeLabel makeLabel(Opcode op, const ActionTokenData &token) {
+  return {static_cast<std::uint64_t>(op), static_cast<std::uint64_t>(token.getToken()),
+          token.isCommutative(), false};
 }
 
-double Variable::evalGetDouble(const SymbolTable &symbol_table) const {
-  // check if variable exists and that the type is a double
-  if (auto pos{symbol_table.find(m_token.getText())}; pos != symbol_table.end()) {
-    if (auto val = std::get_if<double>(&(pos->second))) {
-      return *val;
-    } else {
-      throw RuntimeError{"variable with wrong data type used", m_token.getLocation()};
-    }
-  } else {
-    throw RuntimeError{"variable does not exist yet", m_token.getLocation()};
-  }
+} // namespace
+
+Variable::Variable(std::string_view name, DebugIndex debug) : m_name(name), m_debug(debug) {}
+
+void Variable::printPart(std::string &out, [[maybe_unused]] std::size_t part,
+                         [[maybe_unused]] const bool braces) const {
+  out.append(" ").append(m_name).append(" ");
 }
 
-bool Variable::evalGetBool(const SymbolTable &symbol_table) const {
-  // check if variable exists and that the type is a bool
-  if (auto pos{symbol_table.find(m_token.getText())}; pos != symbol_table.end()) {
-    if (auto val = std::get_if<bool>(&(pos->second))) {
-      return *val;
-    } else {
-      throw RuntimeError{"variable with wrong data type used", m_token.getLocation()};
-    }
-  } else {
-    throw RuntimeError{"variable does not exist yet", m_token.getLocation()};
+void Variable::compile(Bytecode &code, const Operand &as) const {
+  // as an operand the variable must hold the type used, alone it keeps whatever type it holds
+  auto op{Opcode::load};
+  if (as.m_arithmetic) {
+    op = Opcode::load_number;
+  } else if (as.m_boolean) {
+    op = Opcode::load_boolean;
   }
+  code.addVariable(op, m_name, m_debug);
 }
 
-var Variable::eval(const SymbolTable &symbol_table) const {
-  if (auto pos{symbol_table.find(m_token.getText())}; pos != symbol_table.end()) {
-    return pos->second;
-  } else {
-    throw RuntimeError{"variable does not exist yet", m_token.getLocation()};
-  }
-};
+NodeLabel Variable::getLabel() const {
+  return makeLabel(Opcode::load, Fingerprint::hashText(m_name));
+}
 
-DataTypes Variable::getDataType(const SymbolTable &symbol_table) const {
-  if (auto pos{symbol_table.find(m_token.getText())}; pos != symbol_table.end()) {
-    if (auto val = std::get_if<bool>(&(pos->second))) {
-      return DataTypes::bool_;
-    } else if (auto val = std::get_if<double>(&(pos->second))) {
-      return DataTypes::double_;
-    }
-  } else {
-    throw RuntimeError{"variable does not exist yet", m_token.getLocation()};
+AtomicArithmetic::AtomicArithmetic(std::string_view text, DebugIndex debug)
+    : m_text(text), m_debug(debug) {
+  // converted once here so evaluation never parses text
+  if (!convert(m_text, m_value)) {
+    throw SyntaxError{ErrorCode::syntax, "Cannot parse literal", m_debug};
   }
-  unreachable();
 }
 
-AtomicArithmetic::AtomicArithmetic(TokenData &&token) : m_token(std::move(token)) {}
+AtomicArithmetic::AtomicArithmetic(std::string_view text, double value, DebugIndex debug)
+    : m_value(value), m_text(text), m_debug(debug) {}
 
-std::string AtomicArithmetic::toString([[maybe_unused]] const bool braces) const {
-  return m_token.getText();
+bool AtomicArithmetic::convert(std::string_view text, double &value) {
+  const char *last{text.data() + text.size()};
+  auto [end, error] = std::from_chars(text.data(), last, value);
+  return error == std::errc{} && end == last;
 }
 
-double AtomicArithmetic::evalGetDouble([[maybe_unused]] const SymbolTable &symbol_table) const {
-  std::istringstream iss{m_token.getText()};
-  double x{};
-  iss >> x;
-  if (iss.fail()) {
-    throw RuntimeError{"Cannot parse literal", m_token.getLocation()};
-  }
-  return x;
+void AtomicArithmetic::printPart(std::string &out, [[maybe_unused]] std::size_t part,
+                                 [[maybe_unused]] const bool braces) const {
+  out.append(m_text);
 }
 
-var AtomicArithmetic::eval(const SymbolTable &symbol_table) const {
-  return evalGetDouble(symbol_table);
+void AtomicArithmetic::compile(Bytecode &code, [[maybe_unused]] const Operand &as) const {
+  code.addNumber(m_value);
 }
 
-ParenthesesArithmetic::ParenthesesArithmetic(std::unique_ptr<Expression> &&input, TokenData &&token)
-    : m_token(std::move(token)), m_input(dynamic_unique_ptr_cast<Arithmetic>(std::move(input))) {
-  if (!m_input) {
-    throw SyntaxError{"bad data type in parentheses expected arithmetic got boolean",
-                      m_token.getLocation()};
-  }
+NodeLabel AtomicArithmetic::getLabel() const {
+  return makeLabel(Opcode::number, std::bit_cast<std::uint64_t>(m_value));
+}
+
+ParenthesesArithmetic::ParenthesesArithmetic(NodePtr<Arithmetic> &&input, DebugIndex debug)
+    : m_debug(debug), m_input(std::move(input)) {}
+
+void ParenthesesArithmetic::printPart(std::string &out, std::size_t part,
+                                      [[maybe_unused]] const bool braces) const {
+  out.append(part == 0 ? "(" : ")");
 }
 
-std::string ParenthesesArithmetic::toString(const bool braces) const {
-  return {"(" + m_input->toString(braces) + ")"};
+void ParenthesesArithmetic::compile([[maybe_unused]] Bytecode &code,
+                                    [[maybe_unused]] const Operand &as) const {
+  // the value of the operand is left on the stack as it is
 }
 
-double ParenthesesArithmetic::evalGetDouble(const SymbolTable &symbol_table) const {
-  return m_input->evalGetDouble(symbol_table);
+NodeLabel ParenthesesArithmetic::getLabel() const {
+  return {0, 0, false, true};
 }
 
-var ParenthesesArithmetic::eval(const SymbolTable &symbol_table) const {
-  return evalGetDouble(symbol_table);
+std::size_t ParenthesesArithmetic::getOperandCount() const { return 1; }
+
+Operand ParenthesesArithmetic::getOperand([[maybe_unused]] std::size_t index) const {
+  return {m_input.get(), nullptr};
+}
+
+void ParenthesesArithmetic::releaseOperands(std::vector<NodePtr<Expression>> &operands) {
+  operands.push_back(std::move(m_input));
 }
 
-BinaryArithmeticOperation::BinaryArithmeticOperation(std::unique_ptr<Expression> &&left,
+BinaryArithmeticOperation::BinaryArithmeticOperation(NodePtr<Arithmetic> &&left,
                                                      ActionTokenData &&token,
-                                                     std::unique_ptr<Expression> &&right)
-    : m_left(dynamic_unique_ptr_cast<Arithmetic>(std::move(left))), m_token(token),
-      m_right(dynamic_unique_ptr_cast<Arithmetic>(std::move(right))) {
+                                                     NodePtr<Arithmetic> &&right)
+    : m_left(std::move(left)), m_token(token), m_right(std::move(right)) {
   // check token type
   switch (m_token.getToken()) {
   case ActionTokens::Addition:
@@ -124,83 +115,43 @@ BinaryArithmeticOperation::BinaryArithmeticOperation(std::unique_ptr<Expression>
     break;
   }
   default: {
-    throw SyntaxError{"binary arithmetic operator not know", m_token.getLocation()};
+    throw SyntaxError{ErrorCode::syntax, "binary arithmetic operator not know",
+                      m_token.getDebugIndex()};
   }
   }
-  if (!m_left || !m_right) {
-    throw SyntaxError{"Bad data type for binary arithmetic operation " + m_token.getOperation() +
-                          " ",
-                      m_token.getLocation()};
-  }
 }
 
-std::string BinaryArithmeticOperation::toString(const bool braces) const {
-  std::string output{m_left->toString(braces) + m_token.getOperator() + m_right->toString(braces)};
-  if (braces) {
-    return {"(" + output + ")"};
-  } else {
-    return output;
+void BinaryArithmeticOperation::printPart(std::string &out, std::size_t part,
+                                          const bool braces) const {
+  if (part == 1) {
+    out.append(m_token.getOperator());
+  } else if (braces) {
+    out.append(part == 0 ? "(" : ")");
   }
 }
 
-double BinaryArithmeticOperation::evalGetDouble(const SymbolTable &symbol_table) const {
-  double left{m_left->evalGetDouble(symbol_table)};
-  double right{m_right->evalGetDouble(symbol_table)};
-  double result{};
-  auto loc{m_token.getLocation()};
+void BinaryArithmeticOperation::compile(Bytecode &code, [[maybe_unused]] const Operand &as) const {
+  code.addOperation(Opcode::binary_arithmetic, m_token);
+}
 
-  std::feclearexcept(FE_ALL_EXCEPT);
-  switch (m_token.getToken()) {
-  case ActionTokens::Addition: {
-    result = left + right;
-    break;
-  }
-  case ActionTokens::Subtraction: {
-    result = left - right;
-    break;
-  }
-  case ActionTokens::Multiplication: {
-    result = left * right;
-    break;
-  }
-  case ActionTokens::Division: {
-    result = left / right;
-    if (std::fetestexcept(FE_INVALID) || std::fetestexcept(FE_DIVBYZERO) || std::isnan(result) ||
-        std::isinf(result)) {
-      throw RuntimeError{"Bad divide operation", loc};
-    }
-    break;
-  }
-  case ActionTokens::Modulo: {
-    result = std::fmod(left, right);
-    if (std::fetestexcept(FE_INVALID) || std::fetestexcept(FE_DIVBYZERO) || std::isnan(result) ||
-        std::isinf(result)) {
-      throw RuntimeError{"Bad modulo operation", loc};
-    }
-    break;
-  }
-  case ActionTokens::Power: {
-    result = std::pow(left, right);
-    if (std::fetestexcept(FE_INVALID) || std::fetestexcept(FE_DIVBYZERO) || std::isnan(result) ||
-        std::isinf(result)) {
-      throw RuntimeError{"Bad power operation", loc};
-    }
-    break;
-  }
-  default: {
-    unreachable();
-  }
-  }
-  return result;
+NodeLabel BinaryArithmeticOperation::getLabel() const {
+  return makeLabel(Opcode::binary_arithmetic, m_token);
 }
 
-var BinaryArithmeticOperation::eval(const SymbolTable &symbol_table) const {
-  return evalGetDouble(symbol_table);
+std::size_t BinaryArithmeticOperation::getOperandCount() const { return 2; }
+
+Operand BinaryArithmeticOperation::getOperand(std::size_t index) const {
+  return {index == 0 ? m_left.get() : m_right.get(), nullptr};
 }
 
-UnaryArithmeticOperation::UnaryArithmeticOperation(std::unique_ptr<Expression> &&input,
+void BinaryArithmeticOperation::releaseOperands(std::vector<NodePtr<Expression>> &operands) {
+  operands.push_back(std::move(m_left));
+  operands.push_back(std::move(m_right));
+}
+
+UnaryArithmeticOperation::UnaryArithmeticOperation(NodePtr<Arithmetic> &&input,
                                                    ActionTokenData &&token)
-    : m_input(dynamic_unique_ptr_cast<Arithmetic>(std::move(input))), m_token(token) {
+    : m_input(std::move(input)), m_token(token) {
   // check token type
   switch (m_token.getToken()) {
   case ActionTokens::positive:
@@ -208,44 +159,41 @@ UnaryArithmeticOperation::UnaryArithmeticOperation(std::unique_ptr<Expression> &
     break;
   }
   default: {
-    throw SyntaxError{"unary arithmetic operator not know", m_token.getLocation()};
-  }
+    throw SyntaxError{ErrorCode::syntax, "unary arithmetic operator not know",
+                      m_token.getDebugIndex()};
   }
-  if (!m_input) {
-    throw SyntaxError{"Bad data type for unary arithmetic operator " + m_token.getOperation(),
-                      m_token.getLocation()};
   }
 }
 
-std::string UnaryArithmeticOperation::toString(const bool braces) const {
-  std::string out{" "};
-  out += m_token.getOperator();
-  out += m_input->toString(braces);
-  if (braces) {
-    return {"(" + out + ")"};
-  } else {
-    return out;
+void UnaryArithmeticOperation::printPart(std::string &out, std::size_t part,
+                                         const bool braces) const {
+  if (part == 0) {
+    out.append(braces ? "( " : " ").append(m_token.getOperator());
+  } else if (braces) {
+    out.append(")");
   }
 }
 
-double UnaryArithmeticOperation::evalGetDouble(const SymbolTable &symbol_table) const {
-  double input{m_input->evalGetDouble(symbol_table)};
-  switch (m_token.getToken()) {
-  case ActionTokens::positive:
-    return +input;
-  case ActionTokens::negative:
-    return -input;
-  default:
-    unreachable();
-  }
+void UnaryArithmeticOperation::compile(Bytecode &code, [[maybe_unused]] const Operand &as) const {
+  code.addOperation(Opcode::unary_arithmetic, m_token);
+}
+
+NodeLabel UnaryArithmeticOperation::getLabel() const {
+  return makeLabel(Opcode::unary_arithmetic, m_token);
+}
+
+std::size_t UnaryArithmeticOperation::getOperandCount() const { return 1; }
+
+Operand UnaryArithmeticOperation::getOperand([[maybe_unused]] std::size_t index) const {
+  return {m_input.get(), nullptr};
 }
 
-var UnaryArithmeticOperation::eval(const SymbolTable &symbol_table) const {
-  return evalGetDouble(symbol_table);
+void UnaryArithmeticOperation::releaseOperands(std::vector<NodePtr<Expression>> &operands) {
+  operands.push_back(std::move(m_input));
 }
 
-FunctionArithmetic::FunctionArithmetic(std::unique_ptr<Expression> &&input, ActionTokenData &&token)
-    : m_input(dynamic_unique_ptr_cast<Arithmetic>(std::move(input))), m_token(token) {
+FunctionArithmetic::FunctionArithmetic(NodePtr<Arithmetic> &&input, ActionTokenData &&token)
+    : m_input(std::move(input)), m_token(token) {
   switch (m_token.getToken()) {
   case ActionTokens::sin:
   case ActionTokens::cos:
@@ -259,223 +207,155 @@ FunctionArithmetic::FunctionArithmetic(std::unique_ptr<Expression> &&input, Acti
     break;
   }
   default: {
-    throw SyntaxError{"function call not found", m_token.getLocation()};
+    throw SyntaxError{ErrorCode::syntax, "function call not found", m_token.getDebugIndex()};
   }
   }
-  if (!m_input) {
-    throw SyntaxError{"Bad data type when calling function", m_token.getLocation()};
-  }
 }
 
-std::string FunctionArithmetic::toString(const bool braces) const {
-  switch (m_token.getToken()) {
-  case ActionTokens::sin: {
-    return {" sin(" + m_input->toString(braces) + ")"};
-  }
-  case ActionTokens::cos: {
-    return {" cos(" + m_input->toString(braces) + ")"};
-  }
-  case ActionTokens::tan: {
-    return {" tan(" + m_input->toString(braces) + ")"};
-  }
-  case ActionTokens::Atan: {
-    return {" atan(" + m_input->toString(braces) + ")"};
-  }
-  case ActionTokens::Acos: {
-    return {" acos(" + m_input->toString(braces) + ")"};
+void FunctionArithmetic::printPart(std::string &out, std::size_t part,
+                                   [[maybe_unused]] const bool braces) const {
+  if (part == 1) {
+    out.append(")");
+    return;
   }
-  case ActionTokens::Asin: {
-    return {" asin(" + m_input->toString(braces) + ")"};
-  }
-  case ActionTokens::Log: {
-    return {" log(" + m_input->toString(braces) + ")"};
-  }
-  case ActionTokens::Sqrt: {
-    return {" sqrt(" + m_input->toString(braces) + ")"};
-  }
-  case ActionTokens::Int: {
-    return {" Int(" + m_input->toString(braces) + ")"};
-  }
-  default: {
-    unreachable();
-  }
-  }
-}
-
-double FunctionArithmetic::evalGetDouble(const SymbolTable &symbol_table) const {
-  double input{m_input->evalGetDouble(symbol_table)};
-  double result{};
-  auto loc{m_token.getLocation()};
-
-  std::feclearexcept(FE_ALL_EXCEPT);
-
   switch (m_token.getToken()) {
   case ActionTokens::sin: {
-    result = std::sin(input);
-    if (std::fetestexcept(FE_INVALID) || std::isnan(result) || std::isinf(result)) {
-      throw RuntimeError{"Invalid argument to sin", loc};
-    }
+    out.append(" sin(");
     break;
   }
   case ActionTokens::cos: {
-    result = std::cos(input);
-    if (std::fetestexcept(FE_INVALID) || std::isnan(result) || std::isinf(result)) {
-      throw RuntimeError{"Invalid argument to cos", loc};
-    }
+    out.append(" cos(");
     break;
   }
   case ActionTokens::tan: {
-    result = std::tan(input);
-    if (std::fetestexcept(FE_INVALID) || std::isnan(result) || std::isinf(result)) {
-      throw RuntimeError{"Invalid argument to tan", loc};
-    }
+    out.append(" tan(");
     break;
   }
   case ActionTokens::Atan: {
-    result = std::atan(input);
-    if (std::fetestexcept(FE_INVALID) || std::isnan(result) || std::isinf(result)) {
-      throw RuntimeError{"Invalid argument to atan", loc};
-    }
+    out.append(" atan(");
     break;
   }
   case ActionTokens::Acos: {
-    result = std::acos(input);
-    if (std::fetestexcept(FE_INVALID) || std::isnan(result) || std::isinf(result)) {
-      throw RuntimeError{"Invalid argument to acos", loc};
-    }
+    out.append(" acos(");
     break;
   }
   case ActionTokens::Asin: {
-    result = std::asin(input);
-    if (std::fetestexcept(FE_INVALID) || std::isnan(result) || std::isinf(result)) {
-      throw RuntimeError{"Invalid argument to asin", loc};
-    }
+    out.append(" asin(");
     break;
   }
   case ActionTokens::Log: {
-    result = std::log(input);
-    if (std::fetestexcept(FE_INVALID) || std::fetestexcept(FE_DIVBYZERO) || std::isnan(result) ||
-        std::isinf(result)) {
-      throw RuntimeError{"Invalid argument to log", loc};
-    }
+    out.append(" log(");
     break;
   }
   case ActionTokens::Sqrt: {
-    result = std::sqrt(input);
-    if (std::fetestexcept(FE_INVALID) || std::isnan(result) || std::isinf(result)) {
-      throw RuntimeError{"Invalid argument to sqrt", loc};
-    }
+    out.append(" sqrt(");
     break;
   }
   case ActionTokens::Int: {
-    if (input < 0) {
-      result = std::ceil(input);
-    } else {
-      result = std::floor(input);
-    }
+    out.append(" Int(");
     break;
   }
-  default:
+  default: {
     unreachable();
   }
+  }
+}
 
-  return result;
+void FunctionArithmetic::compile(Bytecode &code, [[maybe_unused]] const Operand &as) const {
+  code.addOperation(Opcode::function, m_token);
 }
 
-var FunctionArithmetic::eval(const SymbolTable &symbol_table) const {
-  return evalGetDouble(symbol_table);
+NodeLabel FunctionArithmetic::getLabel() const {
+  return makeLabel(Opcode::function, m_token);
 }
 
-AtomicBoolean::AtomicBoolean(TokenData &&token) : m_token(token) {
-  switch (m_token.getToken()) {
-  case Token::True:
-  case Token::False:
-    break;
-  default:
-    throw SyntaxError{"Boolean required", m_token.getLocation()};
-  }
-};
+std::size_t FunctionArithmetic::getOperandCount() const { return 1; }
 
-std::string AtomicBoolean::toString([[maybe_unused]] const bool braces) const {
-  if (m_token.getToken() == Token::True) {
-    return {" true"};
-  } else if (m_token.getToken() == Token::False) {
-    return {" false "};
-  } else {
-    unreachable();
-  }
+Operand FunctionArithmetic::getOperand([[maybe_unused]] std::size_t index) const {
+  return {m_input.get(), nullptr};
+}
+
+void FunctionArithmetic::releaseOperands(std::vector<NodePtr<Expression>> &operands) {
+  operands.push_back(std::move(m_input));
 }
 
-bool AtomicBoolean::evalGetBool([[maybe_unused]] const SymbolTable &symbol_table) const {
-  if (m_token.getToken() == Token::True) {
-    return true;
-  } else if (m_token.getToken() == Token::False) {
-    return false;
+AtomicBoolean::AtomicBoolean(bool value, DebugIndex debug) : m_value(value), m_debug(debug) {}
+
+void AtomicBoolean::printPart(std::string &out, [[maybe_unused]] std::size_t part,
+                              [[maybe_unused]] const bool braces) const {
+  if (m_value) {
+    out.append(" true");
   } else {
-    unreachable();
+    out.append(" false ");
   }
 }
 
-var AtomicBoolean::eval(const SymbolTable &symbol_table) const { return evalGetBool(symbol_table); }
+void AtomicBoolean::compile(Bytecode &code, [[maybe_unused]] const Operand &as) const {
+  code.addBoolean(m_value);
+}
 
-ParenthesesBoolean::ParenthesesBoolean(std::unique_ptr<Expression> &&input, TokenData &&token)
-    : m_token(std::move(token)), m_input(dynamic_unique_ptr_cast<Boolean>(std::move(input))) {
-  if (!m_input) {
-    throw SyntaxError{"bad data type in parentheses expected boolean got something else",
-                      m_token.getLocation()};
-  }
+NodeLabel AtomicBoolean::getLabel() const {
+  return makeLabel(Opcode::boolean, m_value);
+}
+
+ParenthesesBoolean::ParenthesesBoolean(NodePtr<Boolean> &&input, DebugIndex debug)
+    : m_debug(debug), m_input(std::move(input)) {}
+
+void ParenthesesBoolean::printPart(std::string &out, std::size_t part,
+                                   [[maybe_unused]] const bool braces) const {
+  out.append(part == 0 ? "(" : ")");
+}
+
+void ParenthesesBoolean::compile([[maybe_unused]] Bytecode &code,
+                                 [[maybe_unused]] const Operand &as) const {
+  // the value of the operand is left on the stack as it is
 }
 
-std::string ParenthesesBoolean::toString(const bool braces) const {
-  return {"(" + m_input->toString(braces) + ")"};
+NodeLabel ParenthesesBoolean::getLabel() const {
+  return {0, 0, false, true};
 }
 
-bool ParenthesesBoolean::evalGetBool(const SymbolTable &symbol_table) const {
-  return m_input->evalGetBool(symbol_table);
+std::size_t ParenthesesBoolean::getOperandCount() const { return 1; }
+
+Operand ParenthesesBoolean::getOperand([[maybe_unused]] std::size_t index) const {
+  return {nullptr, m_input.get()};
 }
 
-var ParenthesesBoolean::eval(const SymbolTable &symbol_table) const {
-  return evalGetBool(symbol_table);
+void ParenthesesBoolean::releaseOperands(std::vector<NodePtr<Expression>> &operands) {
+  operands.push_back(std::move(m_input));
 }
 
-BinaryBooleanOperation::BinaryBooleanOperation(std::unique_ptr<Expression> &&left,
+BinaryBooleanOperation::BinaryBooleanOperation(NodePtr<Boolean> &&left,
                                                ActionTokenData &&token,
-                                               std::unique_ptr<Expression> &&right)
-    : m_left(dynamic_unique_ptr_cast<Boolean>(std::move(left))), m_token(token),
-      m_right(dynamic_unique_ptr_cast<Boolean>(std::move(right))) {
+                                               NodePtr<Boolean> &&right)
+    : m_left(std::move(left)), m_token(token), m_right(std::move(right)) {
   switch (m_token.getToken()) {
   case ActionTokens::And:
   case ActionTokens::Or: {
     break;
   }
   default: {
-    throw SyntaxError{"Boolean operation not know", m_token.getLocation()};
-  }
+    throw SyntaxError{ErrorCode::syntax, "Boolean operation not know", m_token.getDebugIndex()};
   }
-  if (!m_left || !m_right) {
-    throw SyntaxError{"Bad data types for boolean operation", m_token.getLocation()};
   }
 }
 
-std::string BinaryBooleanOperation::toString(const bool braces) const {
-  std::string output;
-  switch (m_token.getToken()) {
-
-  case ActionTokens::And: {
-    output = {m_left->toString(braces) + " and " + m_right->toString(braces)};
+void BinaryBooleanOperation::printPart(std::string &out, std::size_t part,
+                                       const bool braces) const {
+  if (part != 1) {
     if (braces) {
-      return {"(" + output + ")"};
-    } else {
-      return output;
+      out.append(part == 0 ? "(" : ")");
     }
+    return;
+  }
+  switch (m_token.getToken()) {
+  case ActionTokens::And: {
+    out.append(" and ");
+    break;
   }
   case ActionTokens::Or: {
-    output = {m_left->toString(braces) + " or " + m_right->toString(braces)};
-    if (braces) {
-      return {"(" + output + ")"};
-    } else {
-      return output;
-    }
+    out.append(" or ");
+    break;
   }
   default: {
     unreachable();
@@ -483,62 +363,69 @@ std::string BinaryBooleanOperation::toString(const bool braces) const {
   }
 }
 
-bool BinaryBooleanOperation::evalGetBool(const SymbolTable &symbol_table) const {
-  bool left{m_left->evalGetBool(symbol_table)};
-  bool right{m_right->evalGetBool(symbol_table)};
-  switch (m_token.getToken()) {
-  case ActionTokens::And:
-    return left && right;
-  case ActionTokens::Or:
-    return left || right;
-  default:
-    unreachable();
-  }
+void BinaryBooleanOperation::compile(Bytecode &code, [[maybe_unused]] const Operand &as) const {
+  code.addOperation(Opcode::binary_boolean, m_token);
+}
+
+NodeLabel BinaryBooleanOperation::getLabel() const {
+  return makeLabel(Opcode::binary_boolean, m_token);
 }
 
-var BinaryBooleanOperation::eval(const SymbolTable &symbol_table) const {
-  return evalGetBool(symbol_table);
+std::size_t BinaryBooleanOperation::getOperandCount() const { return 2; }
+
+Operand BinaryBooleanOperation::getOperand(std::size_t index) const {
+  return {nullptr, index == 0 ? m_left.get() : m_right.get()};
 }
 
-UnaryBooleanOperation::UnaryBooleanOperation(std::unique_ptr<Expression> &&input,
+void BinaryBooleanOperation::releaseOperands(std::vector<NodePtr<Expression>> &operands) {
+  operands.push_back(std::move(m_left));
+  operands.push_back(std::move(m_right));
+}
+
+UnaryBooleanOperation::UnaryBooleanOperation(NodePtr<Boolean> &&input,
                                              ActionTokenData &&token)
-    : m_input(dynamic_unique_ptr_cast<Boolean>(std::move(input))), m_token(token) {
+    : m_input(std::move(input)), m_token(token) {
   switch (m_token.getToken()) {
   case ActionTokens::Not: {
     break;
   }
   default: {
-    throw SyntaxError{"Boolean operation not know", m_token.getLocation()};
-  }
+    throw SyntaxError{ErrorCode::syntax, "Boolean operation not know", m_token.getDebugIndex()};
   }
-  if (!m_input) {
-    throw SyntaxError{"Bad data types for boolean operation", m_token.getLocation()};
   }
 }
 
-std::string UnaryBooleanOperation::toString(const bool braces) const {
-  std::string output{m_input->toString(braces)};
+void UnaryBooleanOperation::printPart(std::string &out, std::size_t part,
+                                      const bool braces) const {
   // currently the only unary boolean token
-  if (braces) {
-    return {" not (" + output + ")"};
-  } else {
-    return {" not " + output};
+  if (part == 0) {
+    out.append(braces ? " not (" : " not ");
+  } else if (braces) {
+    out.append(")");
   }
 }
 
-bool UnaryBooleanOperation::evalGetBool(const SymbolTable &symbol_table) const {
-  bool input{m_input->evalGetBool(symbol_table)};
-  return !input;
+void UnaryBooleanOperation::compile(Bytecode &code, [[maybe_unused]] const Operand &as) const {
+  code.addOperation(Opcode::unary_boolean, m_token);
 }
 
-var UnaryBooleanOperation::eval(const SymbolTable &symbol_table) const {
-  return evalGetBool(symbol_table);
+NodeLabel UnaryBooleanOperation::getLabel() const {
+  return makeLabel(Opcode::unary_boolean, m_token);
 }
 
-Comparision::Comparision(std::unique_ptr<Expression> &&left, ActionTokenData &&token,
-                         std::unique_ptr<Expression> &&right)
-    : m_left(dynamic_unique_ptr_cast<Arithmetic>(std::move(left))), m_token(token),
-      m_right(dynamic_unique_ptr_cast<Arithmetic>(std::move(right))) {
+std::size_t UnaryBooleanOperation::getOperandCount() const { return 1; }
+
+Operand UnaryBooleanOperation::getOperand([[maybe_unused]] std::size_t index) const {
+  return {nullptr, m_input.get()};
+}
+
+void UnaryBooleanOperation::releaseOperands(std::vector<NodePtr<Expression>> &operands) {
+  operands.push_back(std::move(m_input));
+}
+
+Comparision::Comparision(NodePtr<Arithmetic> &&left, ActionTokenData &&token,
+                         NodePtr<Arithmetic> &&right)
+    : m_left(std::move(left)), m_token(token), m_right(std::move(right)) {
   switch (m_token.getToken()) {
   case ActionTokens::Greater_than:
   case ActionTokens::Less_than:
@@ -547,49 +434,34 @@ Comparision::Comparision(std::unique_ptr<Expression> &&left, ActionTokenData &&t
     break;
   }
   default: {
-    throw SyntaxError{"comparison operator not know", m_token.getLocation()};
+    throw SyntaxError{ErrorCode::syntax, "comparison operator not know", m_token.getDebugIndex()};
   }
   }
-  if (!m_left || !m_right) {
-    throw SyntaxError{"Bad data type for comparison operation " + m_token.getOperation() + " ",
-                      m_token.getLocation()};
-  }
 }
 
-std::string Comparision::toString(const bool braces) const {
-  std::string output;
-  switch (m_token.getToken()) {
-  case ActionTokens::Greater_than: {
-    output = {m_left->toString(braces) + " greater_than " + m_right->toString(braces)};
+void Comparision::printPart(std::string &out, std::size_t part, const bool braces) const {
+  if (part != 1) {
     if (braces) {
-      return {"(" + output + ")"};
-    } else {
-      return output;
+      out.append(part == 0 ? "(" : ")");
     }
+    return;
+  }
+  switch (m_token.getToken()) {
+  case ActionTokens::Greater_than: {
+    out.append(" greater_than ");
+    break;
   }
   case ActionTokens::Less_than: {
-    output = {m_left->toString(braces) + " less_than " + m_right->toString(braces)};
-    if (braces) {
-      return {"(" + output + ")"};
-    } else {
-      return output;
-    }
+    out.append(" less_than ");
+    break;
   }
   case ActionTokens::Equal_to: {
-    output = {m_left->toString(braces) + " equal_to " + m_right->toString(braces)};
-    if (braces) {
-      return {"(" + output + ")"};
-    } else {
-      return output;
-    }
+    out.append(" equal_to ");
+    break;
   }
   case ActionTokens::Not_equal_to: {
-    output = {m_left->toString(braces) + " not_equal_to " + m_right->toString(braces)};
-    if (braces) {
-      return {"(" + output + ")"};
-    } else {
-      return output;
-    }
+    out.append(" not_equal_to ");
+    break;
   }
   default: {
     unreachable();
@@ -597,101 +469,65 @@ std::string Comparision::toString(const bool braces) const {
   }
 }
 
-bool Comparision::evalGetBool(const SymbolTable &symbol_table) const {
-  double left{m_left->evalGetDouble(symbol_table)};
-  double right{m_right->evalGetDouble(symbol_table)};
-  switch (m_token.getToken()) {
-  case ActionTokens::Greater_than:
-    return left > right;
-  case ActionTokens::Less_than:
-    return left < right;
-  case ActionTokens::Equal_to:
-    return left == right;
-  case ActionTokens::Not_equal_to:
-    return left != right;
-  default:
-    unreachable();
-  }
+void Comparision::compile(Bytecode &code, [[maybe_unused]] const Operand &as) const {
+  code.addOperation(Opcode::comparison, m_token);
+}
+
+NodeLabel Comparision::getLabel() const {
+  return makeLabel(Opcode::comparison, m_token);
 }
 
-var Comparision::eval(const SymbolTable &symbol_table) const { return evalGetBool(symbol_table); }
+std::size_t Comparision::getOperandCount() const { return 2; }
 
-Assignment::Assignment(std::unique_ptr<Expression> &&value, TokenData &&token, bool create_var)
-    : m_token(token), m_value(std::move(value)), m_create_var(create_var) {
-  if (m_token.getToken() != Token::Id) {
-    throw SyntaxError{"no variable to assign to", m_token.getLocation()};
-  }
+Operand Comparision::getOperand(std::size_t index) const {
+  return {index == 0 ? m_left.get() : m_right.get(), nullptr};
 }
 
-std::string Assignment::toString(const bool braces) const {
-  if (m_create_var) {
-    return {"var " + m_token.getText() + " = " + m_value->toString(braces) + ";\n"};
-  } else {
-    return {" " + m_token.getText() + " = " + m_value->toString(braces) + ";\n"};
-  }
+void Comparision::releaseOperands(std::vector<NodePtr<Expression>> &operands) {
+  operands.push_back(std::move(m_left));
+  operands.push_back(std::move(m_right));
 }
 
-std::string Assignment::evalGetString(SymbolTable &symbol_table) const {
-  auto variable_name = m_token.getText();
+Assignment::Assignment(NodePtr<Expression> &&value, std::string_view name, bool create_var,
+                       DebugIndex debug, bool deep)
+    : m_name(name), m_debug(debug), m_value(std::move(value)), m_create_var(create_var),
+      m_deep(deep) {}
 
-  if (variable_name == "pi" || variable_name == "e" || variable_name == "nan" ||
-      variable_name == "inf") {
-    throw SyntaxError{"Attempted to modify built in constants", m_token.getLocation()};
+Assignment::~Assignment() {
+  if (m_deep) {
+    destroyIteratively(std::move(m_value));
   }
+}
 
-  auto pos{symbol_table.find(variable_name)};
-  bool var_exists = pos != symbol_table.end();
-
-  auto assignment_value = m_value->eval(symbol_table);
-
-  // variable exists and not trying to create new variable
-  if (var_exists && !m_create_var) {
-
-    auto variable_value = pos->second;
+void Assignment::print(std::string &out, const bool braces) const {
+  out.append(m_create_var ? "var " : " ").append(m_name).append(" = ");
+  m_value->print(out, braces);
+  out.append(";\n");
+}
 
-    if (variable_value.index() == assignment_value.index()) {
-      symbol_table[variable_name] = assignment_value;
-    } else {
-      throw RuntimeError{"attempted to assign wrong data type to variable", m_token.getLocation()};
-    }
-  }
-  // variable already exists and trying to create new variable
-  else if (var_exists && m_create_var) {
-    throw RuntimeError{"Tried to create already existing variable", m_token.getLocation()};
-  }
-  // variable does not exist and trying to create new variable
-  else if (!var_exists && m_create_var) {
-    symbol_table[variable_name] = assignment_value;
+void Assignment::compile(Bytecode &code) const {
+  // built in constants are refused before their value is evaluated
+  if (m_name == "pi" || m_name == "e" || m_name == "nan" || m_name == "inf") {
+    code.addConstant(m_debug);
   }
-  // variable does not exist and not trying to create new variable
-  else {
-    throw RuntimeError{"Unkown variable", m_token.getLocation()};
-  }
-  return "";
+  code.addExpression(*m_value);
+  code.addStore(m_name, m_create_var, m_debug);
 }
 
-Print::Print(std::unique_ptr<Expression> &&value) : m_value(std::move(value)) {}
-
-std::string Print::evalGetString(SymbolTable &symbol_table) const {
-
-  var result = m_value->eval(symbol_table);
+Print::Print(NodePtr<Expression> &&value, bool deep) : m_value(std::move(value)), m_deep(deep) {}
 
-  if (auto value = std::get_if<bool>(&result)) {
-
-    if (*value) {
-      return "true\n";
-    } else {
-      return "false\n";
-    }
+Print::~Print() {
+  if (m_deep) {
+    destroyIteratively(std::move(m_value));
   }
-  if (auto value = std::get_if<double>(&result)) {
+}
 
-    std::stringstream buffer;
-    buffer << std::setprecision(4) << *value;
-    auto val{buffer.str() + '\n'};
-    return val;
-  }
-  unreachable();
+void Print::print(std::string &out, const bool braces) const {
+  m_value->print(out, braces);
+  out.append(";\n");
 }
 
-std::string Print::toString(const bool braces) const { return {m_value->toString(braces) + ";\n"}; }
+void Print::compile(Bytecode &code) const {
+  code.addExpression(*m_value);
+  code.addPrint();
+}
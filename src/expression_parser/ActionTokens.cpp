@@ -1,25 +1,27 @@
 #include "ActionTokens.hpp"
-#include <string>
+#include "common.hpp"
 
-ActionTokenData::ActionTokenData(TokenData &lexer_token, ActionTokens token)
-    : m_token(token), m_postion(lexer_token.getPostion()), m_line(lexer_token.getLine()),
-      m_text(lexer_token.getText()) {}
-
-ActionTokenData::ActionTokenData(ActionTokens token) : m_token(token) {}
+ActionTokenData::ActionTokenData(ActionTokens token, DebugIndex debug)
+    : m_token(token), m_debug(debug) {}
 
 ActionTokens ActionTokenData::getToken() const { return m_token; }
 
-const std::string ActionTokenData::getLocation() const {
-  std::string out{"Line: "};
-  out.append(std::to_string(m_line));
-  out.append(" Postion: ");
-  out.append(std::to_string(m_postion));
-  return out;
-}
+DebugIndex ActionTokenData::getDebugIndex() const { return m_debug; }
 
-const std::string ActionTokenData::getText() const { return m_text; }
+bool ActionTokenData::isCommutative() const {
+  switch (m_token) {
+  case ActionTokens::Addition:
+  case ActionTokens::Multiplication:
+  case ActionTokens::And:
+  case ActionTokens::Or:
+  case ActionTokens::Equal_to:
+    return true;
+  default:
+    return false;
+  }
+}
 
-const std::string ActionTokenData::getOperation() const {
+std::string_view ActionTokenData::getOperation() const {
   switch (m_token) {
   case ActionTokens::sin:
     return "sine";
@@ -72,9 +74,10 @@ const std::string ActionTokenData::getOperation() const {
   case ActionTokens::positive:
     return "positive";
   }
+  unreachable();
 }
 
-const std::string ActionTokenData::getOperator() const {
+std::string_view ActionTokenData::getOperator() const {
   switch (m_token) {
   case ActionTokens::sin:
     return "sine";
@@ -127,4 +130,5 @@ const std::string ActionTokenData::getOperator() const {
   case ActionTokens::positive:
     return "+";
   }
+  unreachable();
 }
@@ -0,0 +1,931 @@
+#include "Bytecode.hpp"
+#include "Operations.hpp"
+#include "common.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+namespace {
+
+/*an expression waiting for its operands to be lowered, next is the operand to lower next*/
+struct Frame {
+  Operand m_as;
+  const Expression *m_expression;
+  std::size_t m_next;
+};
+
+const Expression *getExpression(const Operand &operand) {
+  if (operand.m_arithmetic) {
+    return operand.m_arithmetic;
+  }
+  return operand.m_boolean;
+}
+
+/*values popped and pushed by an instruction, as a change in the depth of the stack*/
+std::ptrdiff_t getPushed(Opcode op) {
+  switch (op) {
+  case Opcode::number:
+  case Opcode::boolean:
+  case Opcode::load:
+  case Opcode::load_number:
+  case Opcode::load_boolean: {
+    return 1;
+  }
+  case Opcode::binary_arithmetic:
+  case Opcode::binary_boolean:
+  case Opcode::comparison:
+  case Opcode::print:
+  case Opcode::assign:
+  case Opcode::create: {
+    return -1;
+  }
+  default: {
+    return 0;
+  }
+  }
+}
+
+bool usesSlot(Opcode op) {
+  return op == Opcode::load || op == Opcode::load_number || op == Opcode::load_boolean ||
+         op == Opcode::assign || op == Opcode::create;
+}
+
+/*count values in place or more on the heap, so small programs run without allocating*/
+template <typename T, std::size_t Count> class Buffer {
+private:
+  std::array<T, Count> m_local{};
+  std::vector<T> m_heap{};
+  T *m_data{m_local.data()};
+
+public:
+  explicit Buffer(std::size_t size) {
+    if (size > Count) {
+      m_heap.resize(size);
+      m_data = m_heap.data();
+    }
+  }
+  Buffer(const Buffer &other) = delete;
+  Buffer &operator=(const Buffer &t) = delete;
+  T *data() { return m_data; }
+};
+
+/*a value on the stack while folding, where its instructions start and whether it is a literal*/
+struct FoldEntry {
+  std::size_t m_start;
+  bool m_literal;
+};
+
+bool isLiteral(const Instruction &instruction) {
+  return instruction.m_op == Opcode::number || instruction.m_op == Opcode::boolean;
+}
+
+Instruction makeLiteral(const var &value) {
+  Instruction instruction{Opcode::number, ActionTokens{}, no_debug_info, {}};
+  if (auto typed = std::get_if<bool>(&value)) {
+    instruction.m_op = Opcode::boolean;
+    instruction.m_boolean = *typed;
+  } else {
+    instruction.m_number = *std::get_if<double>(&value);
+  }
+  return instruction;
+}
+
+/*
+apply an operation to literal operands as running it would, false if that fails so the error is
+left to be raised when it runs
+*/
+bool evalConstant(const Instruction &operation, const Instruction *operands, Instruction &result) {
+  const ActionTokenData token{operation.m_action, operation.m_debug};
+  Fault fault{};
+  var value{};
+  switch (operation.m_op) {
+  case Opcode::binary_arithmetic: {
+    value = applyBinary(token, operands[0].m_number, operands[1].m_number, fault);
+    break;
+  }
+  case Opcode::unary_arithmetic: {
+    value = applyUnary(token, operands[0].m_number);
+    break;
+  }
+  case Opcode::function: {
+    value = applyFunction(token, operands[0].m_number, fault);
+    break;
+  }
+  case Opcode::binary_boolean: {
+    value = applyBoolean(token, operands[0].m_boolean, operands[1].m_boolean);
+    break;
+  }
+  case Opcode::unary_boolean: {
+    value = !operands[0].m_boolean;
+    break;
+  }
+  case Opcode::comparison: {
+    value = applyComparison(token, operands[0].m_number, operands[1].m_number);
+    break;
+  }
+  default: {
+    unreachable();
+  }
+  }
+  if (fault) {
+    return false;
+  }
+  result = makeLiteral(value);
+  return true;
+}
+
+/*
+the operation gives its other operand unchanged for every value it may hold, bit for bit and
+without failing, when literal is its left or right operand
+x + 0 is not x when x is -0 and x / 1 fails when x is inf, so neither is an identity
+*/
+bool isIdentity(const Instruction &operation, const Instruction &literal, bool right) {
+  const bool number{literal.m_op == Opcode::number};
+  switch (operation.m_action) {
+  case ActionTokens::Multiplication: {
+    return number && literal.m_number == 1;
+  }
+  case ActionTokens::Addition: {
+    return number && literal.m_number == 0 && std::signbit(literal.m_number);
+  }
+  case ActionTokens::Subtraction: {
+    return right && number && literal.m_number == 0 && !std::signbit(literal.m_number);
+  }
+  case ActionTokens::And: {
+    return !number && literal.m_boolean;
+  }
+  case ActionTokens::Or: {
+    return !number && !literal.m_boolean;
+  }
+  default: {
+    return false;
+  }
+  }
+}
+
+/*- - x and not not b are the operand of the inner operation, as + x is x*/
+bool cancels(const Instruction &operation, const Instruction &operand) {
+  if (operation.m_action == ActionTokens::positive) {
+    return true;
+  }
+  const bool involution{operation.m_action == ActionTokens::negative ||
+                        operation.m_op == Opcode::unary_boolean};
+  return involution && operand.m_op == operation.m_op && operand.m_action == operation.m_action;
+}
+
+/*
+the largest exponent reduce rewrites, pow gives x ^ 0 and x ^ 1 exactly but rounds x ^ 2 on its
+own so x * x may differ from it in the last bit and stays on pow
+*/
+const constexpr double max_reduced_power{1};
+
+/*Int leaves the value unchanged*/
+bool isIntegral(double value) { return !std::isfinite(value) || std::trunc(value) == value; }
+
+/*a power of two with a normal reciprocal, dividing by it is multiplying exactly*/
+bool isPowerOfTwo(double value) {
+  int exponent{};
+  return std::isnormal(value) && std::isnormal(1 / value) &&
+         std::fabs(std::frexp(value, &exponent)) == 0.5;
+}
+
+/*operation with literal as its right operand rewritten to one instruction, false if it stays*/
+bool reduceOperation(const Instruction &operation, double literal, Instruction &result) {
+  Instruction reduced{Opcode::power, operation.m_action, operation.m_debug, {}};
+  switch (operation.m_action) {
+  case ActionTokens::Power: {
+    if (!(literal >= 0 && literal <= max_reduced_power) || std::trunc(literal) != literal) {
+      return false;
+    }
+    reduced.m_exponent = static_cast<std::uint32_t>(literal);
+    break;
+  }
+  case ActionTokens::Division: {
+    if (!isPowerOfTwo(literal)) {
+      return false;
+    }
+    reduced.m_op = Opcode::scale;
+    reduced.m_number = 1 / literal;
+    break;
+  }
+  case ActionTokens::Modulo: {
+    // fmod ignores the sign of the divisor
+    if (!isPowerOfTwo(literal) || std::fabs(literal) < 1) {
+      return false;
+    }
+    reduced.m_op = Opcode::remainder;
+    reduced.m_number = std::fabs(literal);
+    break;
+  }
+  default: {
+    return false;
+  }
+  }
+  result = reduced;
+  return true;
+}
+
+/*
+what identifies the value of an instruction, equal for instructions that always give the same value
+where they run: operands are the value numbers of the operand instructions and a variable has a
+new version each time it is stored to
+*/
+struct ValueKey {
+  Opcode m_op;
+  ActionTokens m_action;
+  std::uint64_t m_payload;
+  std::uint32_t m_left;
+  std::uint32_t m_right;
+
+  bool operator==(const ValueKey &other) const = default;
+};
+
+struct ValueKeyHash {
+  std::size_t operator()(const ValueKey &key) const noexcept {
+    const auto operands{static_cast<std::uint64_t>(key.m_left) << 32 | key.m_right};
+    return Fingerprint{}
+        .mix(static_cast<std::uint64_t>(key.m_op) << 8 | static_cast<std::uint64_t>(key.m_action))
+        .mix(key.m_payload)
+        .mix(operands)
+        .m_low;
+  }
+};
+
+const constexpr std::uint32_t no_value{UINT32_MAX};
+/*smaller subexpressions take as long to evaluate again as to keep and reload*/
+const constexpr std::size_t min_reuse_size{3};
+
+} // namespace
+
+struct Bytecode::Slot {
+  var m_value{};
+  bool m_defined{false};
+  bool m_stored{false};
+};
+
+void Bytecode::add(const Instruction &instruction, std::ptrdiff_t pushed) {
+  m_code.push_back(instruction);
+  m_depth = static_cast<std::size_t>(static_cast<std::ptrdiff_t>(m_depth) + pushed);
+  m_stack_size = std::max(m_stack_size, m_depth);
+}
+
+std::uint32_t Bytecode::addSlot(std::string_view name) {
+  const auto [pos, added] = m_slots.try_emplace(name, static_cast<std::uint32_t>(m_names.size()));
+  if (added) {
+    m_names.push_back(name);
+  }
+  return pos->second;
+}
+
+void Bytecode::addExpression(const Expression &expression) {
+  std::vector<Frame> frames{{{}, &expression, 0}};
+  while (!frames.empty()) {
+    auto &frame{frames.back()};
+    if (frame.m_next < frame.m_expression->getOperandCount()) {
+      const auto operand{frame.m_expression->getOperand(frame.m_next++)};
+      frames.push_back({operand, getExpression(operand), 0});
+      continue;
+    }
+    frame.m_expression->compile(*this, frame.m_as);
+    frames.pop_back();
+  }
+}
+
+void Bytecode::addNumber(double value) {
+  Instruction instruction{Opcode::number, ActionTokens{}, no_debug_info, {}};
+  instruction.m_number = value;
+  add(instruction, 1);
+}
+
+void Bytecode::addBoolean(bool value) {
+  Instruction instruction{Opcode::boolean, ActionTokens{}, no_debug_info, {}};
+  instruction.m_boolean = value;
+  add(instruction, 1);
+}
+
+void Bytecode::addVariable(Opcode op, std::string_view name, DebugIndex debug) {
+  Instruction instruction{op, ActionTokens{}, debug, {}};
+  instruction.m_slot = addSlot(name);
+  add(instruction, 1);
+}
+
+void Bytecode::addOperation(Opcode op, const ActionTokenData &token) {
+  add({op, token.getToken(), token.getDebugIndex(), {}}, getPushed(op));
+}
+
+void Bytecode::addPrint() {
+  add({Opcode::print, ActionTokens{}, no_debug_info, {}}, -1);
+  ++m_statements;
+}
+
+void Bytecode::addStore(std::string_view name, bool create, DebugIndex debug) {
+  Instruction instruction{create ? Opcode::create : Opcode::assign, ActionTokens{}, debug, {}};
+  instruction.m_slot = addSlot(name);
+  add(instruction, -1);
+  ++m_statements;
+}
+
+void Bytecode::addConstant(DebugIndex debug) {
+  add({Opcode::constant, ActionTokens{}, debug, {}}, 0);
+}
+
+void Bytecode::append(const Bytecode &other) {
+  m_code.reserve(m_code.size() + other.m_code.size());
+  for (auto instruction : other.m_code) {
+    if (usesSlot(instruction.m_op)) {
+      instruction.m_slot = addSlot(other.m_names[instruction.m_slot]);
+    } else if (instruction.m_op == Opcode::keep || instruction.m_op == Opcode::reload) {
+      instruction.m_slot += static_cast<std::uint32_t>(m_temporaries);
+    }
+    m_code.push_back(instruction);
+  }
+  m_statements += other.m_statements;
+  m_temporaries += other.m_temporaries;
+  m_stack_size = std::max(m_stack_size, other.m_stack_size);
+}
+
+std::size_t Bytecode::fold() {
+  std::vector<Instruction> code{};
+  code.reserve(m_code.size());
+  std::vector<FoldEntry> stack{};
+  for (const auto &instruction : m_code) {
+    switch (instruction.m_op) {
+    case Opcode::number:
+    case Opcode::boolean:
+    case Opcode::load:
+    case Opcode::load_number:
+    case Opcode::load_boolean: {
+      stack.push_back({code.size(), isLiteral(instruction)});
+      code.push_back(instruction);
+      break;
+    }
+    case Opcode::unary_arithmetic:
+    case Opcode::function:
+    case Opcode::unary_boolean: {
+      // the operand ends with the last instruction added
+      auto &operand{stack.back()};
+      if (operand.m_literal && evalConstant(instruction, &code.back(), code.back())) {
+        break;
+      }
+      if (instruction.m_op != Opcode::function && cancels(instruction, code.back())) {
+        if (instruction.m_action != ActionTokens::positive) {
+          code.pop_back();
+        }
+        break;
+      }
+      operand.m_literal = false;
+      code.push_back(instruction);
+      break;
+    }
+    case Opcode::binary_arithmetic:
+    case Opcode::binary_boolean:
+    case Opcode::comparison: {
+      const auto right{stack.back()};
+      stack.pop_back();
+      auto &left{stack.back()};
+      if (left.m_literal && right.m_literal) {
+        Instruction result{};
+        if (evalConstant(instruction, &code[left.m_start], result)) {
+          code.resize(left.m_start);
+          code.push_back(result);
+          break;
+        }
+      }
+      if (right.m_literal && isIdentity(instruction, code.back(), true)) {
+        code.pop_back();
+        break;
+      }
+      if (left.m_literal && isIdentity(instruction, code[left.m_start], false)) {
+        code.erase(code.begin() + static_cast<std::ptrdiff_t>(left.m_start));
+        left.m_literal = right.m_literal;
+        break;
+      }
+      left.m_literal = false;
+      code.push_back(instruction);
+      break;
+    }
+    case Opcode::reload: {
+      stack.push_back({code.size(), false});
+      code.push_back(instruction);
+      break;
+    }
+    case Opcode::power:
+    case Opcode::scale:
+    case Opcode::remainder: {
+      stack.back().m_literal = false;
+      code.push_back(instruction);
+      break;
+    }
+    case Opcode::print:
+    case Opcode::assign:
+    case Opcode::create: {
+      stack.pop_back();
+      code.push_back(instruction);
+      break;
+    }
+    default: {
+      code.push_back(instruction);
+      break;
+    }
+    }
+  }
+  const auto removed{m_code.size() - code.size()};
+  m_code = std::move(code);
+  return removed;
+}
+
+std::size_t Bytecode::reduce() {
+  std::vector<Instruction> code{};
+  code.reserve(m_code.size());
+  // whether each value on the stack is known to be integral
+  std::vector<bool> integral{};
+  for (const auto &instruction : m_code) {
+    switch (instruction.m_op) {
+    case Opcode::number: {
+      integral.push_back(isIntegral(instruction.m_number));
+      code.push_back(instruction);
+      break;
+    }
+    case Opcode::boolean:
+    case Opcode::load:
+    case Opcode::load_number:
+    case Opcode::load_boolean: {
+      integral.push_back(false);
+      code.push_back(instruction);
+      break;
+    }
+    case Opcode::function: {
+      if (instruction.m_action != ActionTokens::Int) {
+        integral.back() = false;
+        code.push_back(instruction);
+      } else if (!integral.back()) {
+        integral.back() = true;
+        code.push_back(instruction);
+      }
+      break;
+    }
+    case Opcode::binary_arithmetic: {
+      const bool right{integral.back()};
+      integral.pop_back();
+      // the right operand is a literal when the last instruction added is one
+      const bool literal{code.back().m_op == Opcode::number};
+      switch (instruction.m_action) {
+      case ActionTokens::Division: {
+        integral.back() = false;
+        break;
+      }
+      case ActionTokens::Power: {
+        integral.back() = integral.back() && right && literal && code.back().m_number >= 0;
+        break;
+      }
+      default: {
+        integral.back() = integral.back() && right;
+        break;
+      }
+      }
+      if (literal && reduceOperation(instruction, code.back().m_number, code.back())) {
+        break;
+      }
+      code.push_back(instruction);
+      break;
+    }
+    case Opcode::binary_boolean:
+    case Opcode::comparison: {
+      integral.pop_back();
+      integral.back() = false;
+      code.push_back(instruction);
+      break;
+    }
+    case Opcode::reload: {
+      integral.push_back(false);
+      code.push_back(instruction);
+      break;
+    }
+    case Opcode::scale: {
+      integral.back() = false;
+      code.push_back(instruction);
+      break;
+    }
+    case Opcode::print:
+    case Opcode::assign:
+    case Opcode::create: {
+      integral.pop_back();
+      code.push_back(instruction);
+      break;
+    }
+    default: {
+      code.push_back(instruction);
+      break;
+    }
+    }
+  }
+  const auto removed{m_code.size() - code.size()};
+  m_code = std::move(code);
+  return removed;
+}
+
+std::size_t Bytecode::reuse() {
+  const auto count{m_code.size()};
+  // the value number of each instruction, the instruction using its value and its subtree size
+  std::vector<std::uint32_t> numbers(count, no_value);
+  std::vector<std::size_t> parents(count, count);
+  std::vector<std::size_t> sizes(count, 1);
+  std::unordered_map<ValueKey, std::uint32_t, ValueKeyHash> values{};
+  std::vector<std::uint32_t> versions(m_names.size(), 0);
+  // the instructions that pushed the values on the stack when running
+  std::vector<std::size_t> stack{};
+  // the instruction whose value an earlier reuse kept in each temporary
+  std::vector<std::size_t> kept(m_temporaries, count);
+  for (std::size_t i = 0; i < count; ++i) {
+    const auto &instruction{m_code[i]};
+    ValueKey key{instruction.m_op, instruction.m_action, 0, 0, 0};
+    switch (instruction.m_op) {
+    case Opcode::number: {
+      key.m_payload = std::bit_cast<std::uint64_t>(instruction.m_number);
+      break;
+    }
+    case Opcode::boolean: {
+      key.m_payload = instruction.m_boolean;
+      break;
+    }
+    case Opcode::load:
+    case Opcode::load_number:
+    case Opcode::load_boolean: {
+      key.m_left = instruction.m_slot;
+      key.m_right = versions[instruction.m_slot];
+      break;
+    }
+    case Opcode::binary_arithmetic:
+    case Opcode::binary_boolean:
+    case Opcode::comparison: {
+      const auto right{stack.back()};
+      stack.pop_back();
+      const auto left{stack.back()};
+      stack.pop_back();
+      key.m_left = numbers[left];
+      key.m_right = numbers[right];
+      parents[left] = i;
+      parents[right] = i;
+      sizes[i] += sizes[left] + sizes[right];
+      break;
+    }
+    case Opcode::unary_arithmetic:
+    case Opcode::function:
+    case Opcode::unary_boolean:
+    case Opcode::power:
+    case Opcode::scale:
+    case Opcode::remainder: {
+      const auto operand{stack.back()};
+      stack.pop_back();
+      key.m_left = numbers[operand];
+      if (instruction.m_op == Opcode::power) {
+        key.m_payload = instruction.m_exponent;
+      } else if (instruction.m_op == Opcode::scale || instruction.m_op == Opcode::remainder) {
+        key.m_payload = std::bit_cast<std::uint64_t>(instruction.m_number);
+      }
+      parents[operand] = i;
+      sizes[i] += sizes[operand];
+      break;
+    }
+    case Opcode::print: {
+      stack.pop_back();
+      continue;
+    }
+    case Opcode::assign:
+    case Opcode::create: {
+      stack.pop_back();
+      ++versions[instruction.m_slot];
+      continue;
+    }
+    case Opcode::keep: {
+      kept[instruction.m_slot] = stack.back();
+      continue;
+    }
+    case Opcode::reload: {
+      // a value reloaded is the value kept so it is kept again or reloaded like any repeat
+      numbers[i] = numbers[kept[instruction.m_slot]];
+      sizes[i] = sizes[kept[instruction.m_slot]];
+      stack.push_back(i);
+      continue;
+    }
+    default: {
+      continue;
+    }
+    }
+    numbers[i] = values.try_emplace(key, static_cast<std::uint32_t>(values.size())).first->second;
+    stack.push_back(i);
+  }
+
+  std::vector<std::size_t> firsts(values.size(), count);
+  for (std::size_t i = 0; i < count; ++i) {
+    if (numbers[i] != no_value && firsts[numbers[i]] == count) {
+      firsts[numbers[i]] = i;
+    }
+  }
+  // a repeat inside a reused repeat is never evaluated so only the outermost repeats count
+  std::vector<bool> covered(count, false);
+  std::vector<std::size_t> uses(values.size(), 0);
+  auto reused = [&](std::size_t i) {
+    return !covered[i] && firsts[numbers[i]] != i && sizes[i] >= min_reuse_size;
+  };
+  for (std::size_t i = count; i-- > 0;) {
+    if (numbers[i] == no_value) {
+      continue;
+    }
+    covered[i] = parents[i] != count && (covered[parents[i]] || reused(parents[i]));
+    if (!covered[i]) {
+      ++uses[numbers[i]];
+    }
+  }
+
+  std::vector<std::uint32_t> temporaries(values.size(), no_value);
+  std::vector<Instruction> code{};
+  code.reserve(count);
+  // the temporaries of an earlier reuse are all replaced
+  m_temporaries = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    const auto number{numbers[i]};
+    if ((number != no_value && covered[i]) || m_code[i].m_op == Opcode::keep) {
+      continue;
+    }
+    if (number == no_value || uses[number] < 2 || sizes[i] < min_reuse_size) {
+      code.push_back(m_code[i]);
+      continue;
+    }
+    if (firsts[number] == i) {
+      code.push_back(m_code[i]);
+      temporaries[number] = static_cast<std::uint32_t>(m_temporaries++);
+      Instruction keep{Opcode::keep, ActionTokens{}, no_debug_info, {}};
+      keep.m_slot = temporaries[number];
+      code.push_back(keep);
+      continue;
+    }
+    Instruction reload{Opcode::reload, ActionTokens{}, no_debug_info, {}};
+    reload.m_slot = temporaries[number];
+    code.push_back(reload);
+  }
+  const auto removed{m_code.size() - code.size()};
+  // the last pass before running so the instructions are kept at their final size
+  code.shrink_to_fit();
+  m_code = std::move(code);
+  return removed;
+}
+
+bool Bytecode::run(SymbolTable &symbol_table, std::string &out, Fault &fault,
+                   std::size_t &statement) const {
+  Buffer<Slot, 16> slots{m_names.size()};
+  for (std::size_t i = 0; i < m_names.size(); ++i) {
+    if (auto pos{symbol_table.find(m_names[i])}; pos != symbol_table.end()) {
+      slots.data()[i] = {pos->second, true, false};
+    }
+  }
+  const bool ran{execute(slots.data(), out, fault, statement)};
+  // the statements before a failure have run so what they stored is kept
+  for (std::size_t i = 0; i < m_names.size(); ++i) {
+    const auto &slot{slots.data()[i]};
+    if (!slot.m_stored) {
+      continue;
+    }
+    if (auto pos{symbol_table.find(m_names[i])}; pos != symbol_table.end()) {
+      pos->second = slot.m_value;
+    } else {
+      symbol_table.emplace(m_names[i], slot.m_value);
+    }
+  }
+  return ran;
+}
+
+bool Bytecode::execute(Slot *slots, std::string &out, Fault &fault,
+                       std::size_t &statement) const {
+  // the stack of most programs fits in place so running them allocates nothing
+  Buffer<var, 64> stack{m_stack_size};
+  // one past the value on top
+  var *top{stack.data()};
+  Buffer<var, 16> temporaries{m_temporaries};
+  var *kept{temporaries.data()};
+
+  statement = 0;
+  for (const auto &instruction : m_code) {
+    const ActionTokenData token{instruction.m_action, instruction.m_debug};
+    switch (instruction.m_op) {
+    case Opcode::number: {
+      *top++ = instruction.m_number;
+      break;
+    }
+    case Opcode::boolean: {
+      *top++ = instruction.m_boolean;
+      break;
+    }
+    case Opcode::load:
+    case Opcode::load_number:
+    case Opcode::load_boolean: {
+      const auto &slot{slots[instruction.m_slot]};
+      if (!slot.m_defined) {
+        fault.record(ErrorCode::unknown_variable, "variable does not exist yet",
+                     instruction.m_debug);
+        return false;
+      }
+      if ((instruction.m_op == Opcode::load_number &&
+           !std::holds_alternative<double>(slot.m_value)) ||
+          (instruction.m_op == Opcode::load_boolean &&
+           !std::holds_alternative<bool>(slot.m_value))) {
+        fault.record(ErrorCode::wrong_type, "variable with wrong data type used",
+                     instruction.m_debug);
+        return false;
+      }
+      *top++ = slot.m_value;
+      break;
+    }
+    case Opcode::binary_arithmetic: {
+      --top;
+      top[-1] =
+          applyBinary(token, *std::get_if<double>(top - 1), *std::get_if<double>(top), fault);
+      if (fault) {
+        return false;
+      }
+      break;
+    }
+    case Opcode::unary_arithmetic: {
+      top[-1] = applyUnary(token, *std::get_if<double>(top - 1));
+      break;
+    }
+    case Opcode::function: {
+      top[-1] = applyFunction(token, *std::get_if<double>(top - 1), fault);
+      if (fault) {
+        return false;
+      }
+      break;
+    }
+    case Opcode::binary_boolean: {
+      --top;
+      top[-1] = applyBoolean(token, *std::get_if<bool>(top - 1), *std::get_if<bool>(top));
+      break;
+    }
+    case Opcode::unary_boolean: {
+      top[-1] = !*std::get_if<bool>(top - 1);
+      break;
+    }
+    case Opcode::comparison: {
+      --top;
+      top[-1] = applyComparison(token, *std::get_if<double>(top - 1), *std::get_if<double>(top));
+      break;
+    }
+    case Opcode::print: {
+      appendValue(out, *--top);
+      ++statement;
+      break;
+    }
+    case Opcode::assign: {
+      auto &slot{slots[instruction.m_slot]};
+      --top;
+      if (!slot.m_defined) {
+        fault.record(ErrorCode::unknown_variable, "Unkown variable", instruction.m_debug);
+        return false;
+      }
+      if (slot.m_value.index() != top->index()) {
+        fault.record(ErrorCode::wrong_type, "attempted to assign wrong data type to variable",
+                     instruction.m_debug);
+        return false;
+      }
+      slot.m_value = *top;
+      slot.m_stored = true;
+      ++statement;
+      break;
+    }
+    case Opcode::create: {
+      auto &slot{slots[instruction.m_slot]};
+      --top;
+      if (slot.m_defined) {
+        fault.record(ErrorCode::existing_variable, "Tried to create already existing variable",
+                     instruction.m_debug);
+        return false;
+      }
+      slot = {*top, true, true};
+      ++statement;
+      break;
+    }
+    case Opcode::power: {
+      top[-1] = applyPower(token, *std::get_if<double>(top - 1), instruction.m_exponent, fault);
+      if (fault) {
+        return false;
+      }
+      break;
+    }
+    case Opcode::scale: {
+      top[-1] = applyScale(token, *std::get_if<double>(top - 1), instruction.m_number, fault);
+      if (fault) {
+        return false;
+      }
+      break;
+    }
+    case Opcode::remainder: {
+      top[-1] = applyRemainder(token, *std::get_if<double>(top - 1), instruction.m_number, fault);
+      if (fault) {
+        return false;
+      }
+      break;
+    }
+    case Opcode::keep: {
+      kept[instruction.m_slot] = top[-1];
+      break;
+    }
+    case Opcode::reload: {
+      *top++ = kept[instruction.m_slot];
+      break;
+    }
+    case Opcode::constant: {
+      fault.record(ErrorCode::constant, "Attempted to modify built in constants",
+                   instruction.m_debug);
+      return false;
+    }
+    default: {
+      unreachable();
+    }
+    }
+  }
+  return true;
+}
+
+Fingerprint Bytecode::getFingerprint(bool commutative, std::vector<Fingerprint> *subtrees) const {
+  auto program{Fingerprint{}.mix(m_statements)};
+  // the fingerprints of the values on the stack when running
+  std::vector<Fingerprint> stack{};
+  for (const auto &instruction : m_code) {
+    auto op{instruction.m_op};
+    if (op == Opcode::load_number || op == Opcode::load_boolean) {
+      op = Opcode::load;
+    }
+    auto fingerprint{Fingerprint{}.mix(static_cast<std::uint64_t>(op))};
+    switch (op) {
+    case Opcode::number: {
+      fingerprint = fingerprint.mix(std::bit_cast<std::uint64_t>(instruction.m_number));
+      break;
+    }
+    case Opcode::boolean: {
+      fingerprint = fingerprint.mix(instruction.m_boolean);
+      break;
+    }
+    case Opcode::load: {
+      fingerprint = fingerprint.mix(Fingerprint::hashText(m_names[instruction.m_slot]));
+      break;
+    }
+    case Opcode::binary_arithmetic:
+    case Opcode::binary_boolean:
+    case Opcode::comparison: {
+      auto right{stack.back()};
+      stack.pop_back();
+      auto left{stack.back()};
+      stack.pop_back();
+      if (commutative && ActionTokenData{instruction.m_action}.isCommutative() && right < left) {
+        std::swap(left, right);
+      }
+      fingerprint = fingerprint.mix(static_cast<std::uint64_t>(instruction.m_action))
+                        .mix(left)
+                        .mix(right);
+      break;
+    }
+    case Opcode::unary_arithmetic:
+    case Opcode::function:
+    case Opcode::unary_boolean: {
+      fingerprint = fingerprint.mix(static_cast<std::uint64_t>(instruction.m_action))
+                        .mix(stack.back());
+      stack.pop_back();
+      break;
+    }
+    case Opcode::print: {
+      program = program.mix(fingerprint.mix(stack.back()));
+      stack.pop_back();
+      continue;
+    }
+    case Opcode::assign:
+    case Opcode::create: {
+      program = program.mix(Fingerprint{}
+                                .mix(static_cast<std::uint64_t>(Opcode::assign))
+                                .mix(Fingerprint::hashText(m_names[instruction.m_slot]))
+                                .mix(op == Opcode::create)
+                                .mix(stack.back()));
+      stack.pop_back();
+      continue;
+    }
+    default: {
+      continue;
+    }
+    }
+    stack.push_back(fingerprint);
+    if (subtrees) {
+      subtrees->push_back(fingerprint);
+    }
+  }
+  return program;
+}
+
+std::size_t Bytecode::getMemoryUsage() const {
+  // a node of the map holds its entry and the pointer to the next node
+  return m_code.capacity() * sizeof(Instruction) + m_names.capacity() * sizeof(std::string_view) +
+         m_slots.bucket_count() * sizeof(void *) +
+         m_slots.size() * (sizeof(decltype(m_slots)::value_type) + sizeof(void *));
+}
@@ -0,0 +1,44 @@
+#include "DebugInfo.hpp"
+#include <algorithm>
+#include <utility>
+
+void DebugInfo::setSource(std::vector<std::uint32_t> line_starts, const SourceLocation &origin,
+                          std::size_t tokens) {
+  m_line_starts = std::move(line_starts);
+  m_origin = origin;
+  m_ends.reserve(m_ends.size() + tokens);
+}
+
+DebugIndex DebugInfo::addLocation(const TokenData &token) {
+  // the end of input counts as a character for its postion
+  m_ends.push_back(token.getOffset() + std::max(token.getLength(), std::uint32_t{1}));
+  return static_cast<DebugIndex>(m_ends.size() - 1);
+}
+
+std::string_view DebugInfo::addText(std::string_view text) {
+  if (text.empty()) {
+    return {};
+  }
+  auto *memory{static_cast<char *>(m_text.allocate(text.size(), alignof(char)))};
+  std::copy(text.begin(), text.end(), memory);
+  m_text_bytes += text.size();
+  return {memory, text.size()};
+}
+
+SourceLocation DebugInfo::getLocation(DebugIndex index) const {
+  if (index == no_debug_info) {
+    return {};
+  }
+  // a token never spans lines so its last character is on the line it starts on
+  const auto last{m_ends[index] - 1};
+  const auto line{std::upper_bound(m_line_starts.begin(), m_line_starts.end(), last) -
+                  m_line_starts.begin() - 1};
+  return TokenData{Token::EOF_sym, last, 1, static_cast<std::uint32_t>(line)}.getLocation(
+      m_line_starts, m_origin);
+}
+
+std::size_t DebugInfo::size() const { return m_ends.size(); }
+
+std::size_t DebugInfo::getMemoryUsage() const {
+  return (m_ends.capacity() + m_line_starts.capacity()) * sizeof(std::uint32_t) + m_text_bytes;
+}
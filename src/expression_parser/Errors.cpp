@@ -1,25 +1,167 @@
 #include "Errors.hpp"
+#include "common.hpp"
+#include <utility>
 
-LexicalError::LexicalError(std::string message, std::string location) {
+std::string_view getHeading(ErrorCode code) {
+  switch (code) {
+  case ErrorCode::lexical:
+    return "Lexing Error\n";
+  case ErrorCode::syntax:
+  case ErrorCode::static_type:
+  case ErrorCode::constant:
+    return "Syntax Error Occurred\n";
+  case ErrorCode::unknown_variable:
+  case ErrorCode::wrong_type:
+  case ErrorCode::existing_variable:
+  case ErrorCode::domain:
+    return "Runtime Error\n";
+  default:
+    unreachable();
+  }
+}
+
+Fault::Fault(ErrorCode code, std::string_view description, const SourceLocation &location,
+             std::string detail)
+    : m_code(code), m_description(description), m_detail(std::move(detail)),
+      m_location(location) {}
+
+Fault::Fault(ErrorCode code, std::string_view description, DebugIndex debug)
+    : m_code(code), m_description(description), m_debug(debug), m_located(false) {}
+
+Fault::operator bool() const { return m_code != ErrorCode::none; }
+
+void Fault::record(ErrorCode code, std::string_view description, DebugIndex debug) {
+  if (m_code == ErrorCode::none) {
+    *this = Fault{code, description, debug};
+  }
+}
+
+void Fault::locate(const DebugInfo &debug_info) {
+  if (m_located) {
+    return;
+  }
+  m_location = debug_info.getLocation(m_debug);
+  m_located = true;
+}
+
+std::string Fault::getDescription() const {
+  std::string out{m_description};
+  out.append(m_detail);
+  return out;
+}
+
+EvalError Fault::getError() const {
+  return {m_code, m_description, m_detail, m_location.m_line, m_location.m_postion};
+}
+
+void Fault::raise() const {
+  switch (m_code) {
+  case ErrorCode::lexical:
+    throw LexicalError{getDescription(), m_location};
+  case ErrorCode::syntax:
+  case ErrorCode::static_type:
+  case ErrorCode::constant:
+    if (!m_located) {
+      throw SyntaxError{m_code, getDescription(), m_debug};
+    }
+    throw SyntaxError{m_code, getDescription(), m_location};
+  default:
+    if (!m_located) {
+      throw RuntimeError{m_code, getDescription(), m_debug};
+    }
+    throw RuntimeError{m_code, getDescription(), m_location};
+  }
+}
+
+LexicalError::LexicalError(std::string_view message, const SourceLocation &location)
+    : m_description(message), m_location(location) {
   m_message.append(message);
   m_message.append(" ");
-  m_message.append(location);
+  m_message.append(location.toString());
 };
 
 const char *LexicalError::what() const noexcept { return m_message.c_str(); };
 
-SyntaxError::SyntaxError(std::string message, std::string location) {
+std::string_view LexicalError::getDescription() const { return m_description; }
+
+const SourceLocation &LexicalError::getLocation() const { return m_location; }
+
+Fault LexicalError::getFault() const {
+  return {ErrorCode::lexical, {}, m_location, m_description};
+}
+
+SyntaxError::SyntaxError(ErrorCode code, std::string_view message,
+                         const SourceLocation &location)
+    : m_description(message), m_location(location), m_code(code) {
   m_message.append(message);
   m_message.append(" ");
-  m_message.append(location);
+  m_message.append(location.toString());
+}
+
+SyntaxError::SyntaxError(ErrorCode code, std::string_view message, DebugIndex debug)
+    : m_description(message), m_debug(debug), m_located(false), m_code(code) {
+  m_message.append(message);
 }
 
 const char *SyntaxError::what() const noexcept { return m_message.c_str(); }
 
-RuntimeError::RuntimeError(std::string message, std::string location) {
+std::string_view SyntaxError::getDescription() const { return m_description; }
+
+const SourceLocation &SyntaxError::getLocation() const { return m_location; }
+
+ErrorCode SyntaxError::getCode() const { return m_code; }
+
+Fault SyntaxError::getFault() const {
+  Fault fault{m_code, {}, m_location, m_description};
+  fault.m_debug = m_debug;
+  fault.m_located = m_located;
+  return fault;
+}
+
+void SyntaxError::locate(const DebugInfo &debug_info) {
+  if (m_located) {
+    return;
+  }
+  m_location = debug_info.getLocation(m_debug);
+  m_message.append(" ");
+  m_message.append(m_location.toString());
+  m_located = true;
+}
+
+RuntimeError::RuntimeError(ErrorCode code, std::string_view message,
+                           const SourceLocation &location)
+    : m_description(message), m_location(location), m_code(code) {
   m_message.append(message);
   m_message.append(" ");
-  m_message.append(location);
+  m_message.append(location.toString());
+}
+
+RuntimeError::RuntimeError(ErrorCode code, std::string_view message, DebugIndex debug)
+    : m_description(message), m_debug(debug), m_located(false), m_code(code) {
+  m_message.append(message);
 }
 
 const char *RuntimeError::what() const noexcept { return m_message.c_str(); }
+
+std::string_view RuntimeError::getDescription() const { return m_description; }
+
+const SourceLocation &RuntimeError::getLocation() const { return m_location; }
+
+ErrorCode RuntimeError::getCode() const { return m_code; }
+
+Fault RuntimeError::getFault() const {
+  Fault fault{m_code, {}, m_location, m_description};
+  fault.m_debug = m_debug;
+  fault.m_located = m_located;
+  return fault;
+}
+
+void RuntimeError::locate(const DebugInfo &debug_info) {
+  if (m_located) {
+    return;
+  }
+  m_location = debug_info.getLocation(m_debug);
+  m_message.append(" ");
+  m_message.append(m_location.toString());
+  m_located = true;
+}
@@ -1,5 +1,6 @@
 #include "ExpGen.hpp"
 #include "AST.hpp"
+#include "DebugInfo.hpp"
 #include "Random.hpp"
 #include "common.hpp"
 #include "tokens.hpp"
@@ -11,23 +12,28 @@ const constexpr std::size_t max_iterations{10};
 
 struct ExpGen::Data {
   Random m_random{};
+  /*the text of nodes made outside a program*/
+  DebugInfo m_debug_info{};
 };
 
-ExpGen::ExpGen() : m_data(std::make_unique<Data>()) {}
+ExpGen::ExpGen(NodeAllocation allocation)
+    : m_allocation(allocation), m_data(std::make_unique<Data>()) {
+  m_nodes = {nullptr, &m_data->m_debug_info};
+}
 
 ExpGen::~ExpGen() = default;
 
-std::unique_ptr<Arithmetic> ExpGen::genArithmetic(const double prob, bool unary) {
+NodePtr<Arithmetic> ExpGen::genArithmetic(const double prob, bool unary) {
   // random increasing probability with each recursion a root node is choosen
   double p{m_data->m_random.getReal0to1()};
   if (p > prob) {
     bool var{m_data->m_random.getBool()};
     if (var && !m_doubles.empty()) {
       auto it{std::next(m_doubles.begin(), m_data->m_random.getInteger0toN(m_doubles.size()))};
-      return std::make_unique<Variable>(TokenData{Token::Id, 0, 0, *it});
+      return m_nodes.make<Variable>(m_nodes.getDebugInfo().addText(*it));
     } else {
-      return std::make_unique<AtomicArithmetic>(
-          TokenData{Token::Number, 0, 0, std::to_string(m_data->m_random.getReal0to9())});
+      return m_nodes.make<AtomicArithmetic>(
+          m_nodes.getDebugInfo().addText(std::to_string(m_data->m_random.getReal0to9())));
     }
   } else {
     auto arith_prob{m_data->m_random.getInteger1to12()};
@@ -40,11 +46,10 @@ std::unique_ptr<Arithmetic> ExpGen::genArithmetic(const double prob, bool unary)
       auto left{genArithmetic(prob / 1.1, unary)};
       ActionTokens t{m_data->m_random.getArithBinaryOp()};
       auto right{genArithmetic(prob / 1.1, unary)};
-      auto out = std::make_unique<BinaryArithmeticOperation>(std::move(left), t, std::move(right));
+      auto out = m_nodes.make<BinaryArithmeticOperation>(std::move(left), t, std::move(right));
 
       if (m_data->m_random.getInteger1to12() >= 10) {
-        return std::make_unique<ParenthesesArithmetic>(std::move(out),
-                                                       TokenData{Token::Lp, 0, 0, "("});
+        return m_nodes.make<ParenthesesArithmetic>(std::move(out));
       } else {
         return out;
       }
@@ -53,11 +58,10 @@ std::unique_ptr<Arithmetic> ExpGen::genArithmetic(const double prob, bool unary)
 
       auto input{genArithmetic(prob / 1.1, unary)};
       ActionTokens t{m_data->m_random.getFunction()};
-      auto out = std::make_unique<FunctionArithmetic>(std::move(input), t);
+      auto out = m_nodes.make<FunctionArithmetic>(std::move(input), t);
 
       if (m_data->m_random.getInteger1to12() >= 10) {
-        return std::make_unique<ParenthesesArithmetic>(std::move(out),
-                                                       TokenData{Token::Lp, 0, 0, "("});
+        return m_nodes.make<ParenthesesArithmetic>(std::move(out));
       } else {
         return out;
       }
@@ -66,11 +70,10 @@ std::unique_ptr<Arithmetic> ExpGen::genArithmetic(const double prob, bool unary)
       // do not generate any more unary operators
       auto left{genArithmetic(prob / 1.1, false)};
       ActionTokens t{m_data->m_random.getArithUnaryOp()};
-      auto out = std::make_unique<UnaryArithmeticOperation>(std::move(left), t);
+      auto out = m_nodes.make<UnaryArithmeticOperation>(std::move(left), t);
 
       if (m_data->m_random.getInteger1to12() >= 10) {
-        return std::make_unique<ParenthesesArithmetic>(std::move(out),
-                                                       TokenData{Token::Lp, 0, 0, "("});
+        return m_nodes.make<ParenthesesArithmetic>(std::move(out));
       } else {
         return out;
       }
@@ -80,7 +83,7 @@ std::unique_ptr<Arithmetic> ExpGen::genArithmetic(const double prob, bool unary)
   }
 }
 
-std::unique_ptr<Boolean> ExpGen::genBoolean(const double prob, bool unary) {
+NodePtr<Boolean> ExpGen::genBoolean(const double prob, bool unary) {
   double p{m_data->m_random.getReal0to1()};
   // root node
   if (p > prob) {
@@ -88,12 +91,12 @@ std::unique_ptr<Boolean> ExpGen::genBoolean(const double prob, bool unary) {
     bool var{m_data->m_random.getBool()};
     if (var && !m_bools.empty()) {
       auto it{std::next(m_bools.begin(), m_data->m_random.getInteger0toN(m_bools.size()))};
-      return std::make_unique<Variable>(TokenData{Token::Id, 0, 0, *it});
+      return m_nodes.make<Variable>(m_nodes.getDebugInfo().addText(*it));
     } else {
       if (m_data->m_random.get0or1()) {
-        return std::make_unique<AtomicBoolean>(TokenData{Token::True, 0, 0, "true"});
+        return m_nodes.make<AtomicBoolean>(true);
       } else {
-        return std::make_unique<AtomicBoolean>(TokenData{Token::False, 0, 0, "false"});
+        return m_nodes.make<AtomicBoolean>(false);
       }
     }
   } else {
@@ -104,11 +107,10 @@ std::unique_ptr<Boolean> ExpGen::genBoolean(const double prob, bool unary) {
       ActionTokens t{m_data->m_random.getBinaryOp()};
       auto right{genBoolean(prob / 1.1, unary)};
 
-      auto out = std::make_unique<BinaryBooleanOperation>(std::move(left), t, std::move(right));
+      auto out = m_nodes.make<BinaryBooleanOperation>(std::move(left), t, std::move(right));
 
       if (m_data->m_random.getInteger1to12() >= 10) {
-        return std::make_unique<ParenthesesBoolean>(std::move(out),
-                                                    TokenData{Token::Lp, 0, 0, "("});
+        return m_nodes.make<ParenthesesBoolean>(std::move(out));
       } else {
         return out;
       }
@@ -118,19 +120,18 @@ std::unique_ptr<Boolean> ExpGen::genBoolean(const double prob, bool unary) {
       auto left{genArithmetic(prob / 1.1, unary)};
       ActionTokens t{m_data->m_random.getCompOp()};
       auto right{genArithmetic(prob / 1.1, unary)};
-      auto out = std::make_unique<Comparision>(std::move(left), t, std::move(right));
-      return std::make_unique<ParenthesesBoolean>(std::move(out), TokenData{Token::Lp, 0, 0, "("});
+      auto out = m_nodes.make<Comparision>(std::move(left), t, std::move(right));
+      return m_nodes.make<ParenthesesBoolean>(std::move(out));
 
     } else if (arith_prob >= 9 && arith_prob <= 12 && unary) {
 
       // do not generate any more unary operators
       auto left{genBoolean(prob / 1.1, false)};
       ActionTokens t{ActionTokens::Not}; // currently the only unary boolean token
-      auto out = std::make_unique<UnaryBooleanOperation>(std::move(left), t);
+      auto out = m_nodes.make<UnaryBooleanOperation>(std::move(left), t);
 
       if (m_data->m_random.getInteger1to12() >= 10) {
-        return std::make_unique<ParenthesesBoolean>(std::move(out),
-                                                    TokenData{Token::Lp, 0, 0, "("});
+        return m_nodes.make<ParenthesesBoolean>(std::move(out));
       } else {
         return out;
       }
@@ -141,7 +142,8 @@ std::unique_ptr<Boolean> ExpGen::genBoolean(const double prob, bool unary) {
 }
 
 std::unique_ptr<Program> ExpGen::getStatements(std::size_t count) {
-  auto out{std::make_unique<Program>()};
+  auto out{std::make_unique<Program>(m_allocation)};
+  m_nodes = out->getAllocator();
   // produce count number of statements
   for (std::size_t i = 0; i < count; ++i) {
     bool assignment{m_data->m_random.getBool()};
@@ -155,16 +157,18 @@ std::unique_ptr<Program> ExpGen::getStatements(std::size_t count) {
       // double
       if (type) {
         auto exp_temp = genArithmetic();
-        auto val{std::make_unique<Assignment>(std::move(exp_temp), TokenData{Token::Id, 0, 0, var},
-                                              true)};
+        auto val{m_nodes.make<Assignment>(std::move(exp_temp),
+                                          m_nodes.getDebugInfo().addText(var), true,
+                                          no_debug_info, false)};
         out->append(std::move(val));
         m_doubles.push_back(var);
         m_symbol_table[var] = DataTypes::double_;
         // bool
       } else {
         auto exp_temp = genBoolean();
-        auto val{std::make_unique<Assignment>(std::move(exp_temp), TokenData{Token::Id, 0, 0, var},
-                                              true)};
+        auto val{m_nodes.make<Assignment>(std::move(exp_temp),
+                                          m_nodes.getDebugInfo().addText(var), true,
+                                          no_debug_info, false)};
         out->append(std::move(val));
         m_bools.push_back(var);
         m_symbol_table[var] = DataTypes::bool_;
@@ -179,14 +183,16 @@ std::unique_ptr<Program> ExpGen::getStatements(std::size_t count) {
       // double
       if (type == DataTypes::double_) {
         auto exp_temp = genArithmetic();
-        auto val{std::make_unique<Assignment>(std::move(exp_temp), TokenData{Token::Id, 0, 0, var},
-                                              false)};
+        auto val{m_nodes.make<Assignment>(std::move(exp_temp),
+                                          m_nodes.getDebugInfo().addText(var), false,
+                                          no_debug_info, false)};
         out->append(std::move(val));
         // bool
       } else {
         auto exp_temp = genBoolean();
-        auto val{std::make_unique<Assignment>(std::move(exp_temp), TokenData{Token::Id, 0, 0, var},
-                                              false)};
+        auto val{m_nodes.make<Assignment>(std::move(exp_temp),
+                                          m_nodes.getDebugInfo().addText(var), false,
+                                          no_debug_info, false)};
         out->append(std::move(val));
       }
     } else if (!assignment) {
@@ -194,17 +200,19 @@ std::unique_ptr<Program> ExpGen::getStatements(std::size_t count) {
       // double
       if (type) {
         auto exp_temp = genArithmetic();
-        auto val{std::make_unique<Print>(std::move(exp_temp))};
+        auto val{m_nodes.make<Print>(std::move(exp_temp), false)};
         out->append(std::move(val));
 
         // bool
       } else {
         auto exp_temp = genBoolean();
-        auto val{std::make_unique<Print>(std::move(exp_temp))};
+        auto val{m_nodes.make<Print>(std::move(exp_temp), false)};
         out->append(std::move(val));
       }
     }
   }
+  // nodes made outside a program are on the heap
+  m_nodes = {nullptr, &m_data->m_debug_info};
   return out;
 }
 
@@ -1,7 +1,61 @@
 #include "Interpreter.hpp"
+#include "Errors.hpp"
+#include "Lexer.hpp"
+#include "MappedFile.hpp"
 #include "Parser.hpp"
+#include "Scanner.hpp"
+#include "StatementStream.hpp"
+#include <algorithm>
+#include <cerrno>
 #include <cmath>
+#include <fstream>
 #include <limits>
+#include <system_error>
+#include <vector>
+
+namespace {
+
+void execute(std::string_view source, const SourceLocation &origin, SymbolTable &symbol_table,
+             std::ostream &out, std::uint32_t recursion_limit) {
+  Parser parser{NodeAllocation::arena, recursion_limit};
+  out << parser.genAST(Lexer{source, origin}.tokenize())->eval(symbol_table);
+}
+
+/*run every statement the stream has completed so far*/
+void runStatements(StatementStream &statements, SymbolTable &symbol_table, std::ostream &out,
+                   std::uint32_t recursion_limit) {
+  std::string_view statement{};
+  SourceLocation origin{};
+  while (statements.next(statement, origin)) {
+    execute(statement, origin, symbol_table, out, recursion_limit);
+  }
+}
+
+/*text left without a ; is either blank or an error worth reporting*/
+void runRest(const StatementStream &statements, SymbolTable &symbol_table, std::ostream &out,
+             std::uint32_t recursion_limit) {
+  SourceLocation origin{};
+  const auto rest{statements.rest(origin)};
+  if (std::all_of(rest.begin(), rest.end(), [](char c) { return hasCharClass(c, char_space); })) {
+    return;
+  }
+  execute(rest, origin, symbol_table, out, recursion_limit);
+}
+
+/*parse and run a source, false with the error in fault once one is found*/
+bool run(std::string_view s, SymbolTable &symbol_table, std::string &out, Fault &fault,
+         std::uint32_t recursion_limit, ProgramCache *cache) {
+  if (cache != nullptr) {
+    const auto program{cache->get(s, recursion_limit, fault)};
+    return program && program->eval(symbol_table, out, fault);
+  }
+  // the program is dropped once run, so its nodes are freed all at once
+  Parser parser{NodeAllocation::arena, recursion_limit};
+  const auto program{parser.genAST(s, fault)};
+  return program && program->eval(symbol_table, out, fault);
+}
+
+} // namespace
 
 Interpreter::Interpreter() {
   m_symbol_table["pi"] = 4.0 * std::atan(1.0);
@@ -10,12 +64,72 @@ Interpreter::Interpreter() {
   m_symbol_table["inf"] = std::numeric_limits<double>::infinity();
 }
 
-std::string Interpreter::evaluate(std::string &s) {
-  Parser parser{};
-  auto val = parser.genAST(s);
+std::string Interpreter::evaluate(std::string_view s) {
+  std::string out{};
+  if (Fault fault{}; !run(s, m_symbol_table, out, fault, m_recursion_limit, m_cache)) {
+    fault.raise();
+  }
+  return out;
+}
+
+EvalResult Interpreter::tryEvaluate(std::string_view s) {
+  std::string out{};
+  if (Fault fault{}; !run(s, m_symbol_table, out, fault, m_recursion_limit, m_cache)) {
+    return fault.getError();
+  }
+  return out;
+}
+
+void Interpreter::runFile(const std::string &path, std::ostream &out) {
+  const MappedFile file{path};
+  if (!file.isMapped()) {
+    std::ifstream in{path, std::ios::binary};
+    if (!in) {
+      throw std::system_error{errno, std::generic_category(), "cannot open " + path};
+    }
+    runStream(in, out);
+    return;
+  }
+  StatementStream statements{};
+  statements.feed(file.getText());
+  runStatements(statements, m_symbol_table, out, m_recursion_limit);
+  runRest(statements, m_symbol_table, out, m_recursion_limit);
+}
+
+void Interpreter::runStream(std::istream &in, std::ostream &out, std::size_t chunk_size) {
+  StatementStream statements{};
+  std::vector<char> chunk(std::max(chunk_size, std::size_t{1}));
+  while (in) {
+    in.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+    statements.feed({chunk.data(), static_cast<std::size_t>(in.gcount())});
+    runStatements(statements, m_symbol_table, out, m_recursion_limit);
+  }
+  runRest(statements, m_symbol_table, out, m_recursion_limit);
+}
+
+std::string Interpreter::evaluate(std::string_view s, std::size_t threads) {
+  auto val = Parser::genASTParallel(s, threads, NodeAllocation::arena, m_recursion_limit);
   return val->eval(m_symbol_table);
 }
 
+std::string Interpreter::evaluate(const Worksheet &worksheet) {
+  return worksheet.eval(m_symbol_table);
+}
+
+void Interpreter::validate(std::string_view s) const {
+  Parser parser{NodeAllocation::heap, m_recursion_limit};
+  parser.validate(s);
+}
+
+Fingerprint Interpreter::getFingerprint(std::string_view s, bool commutative) const {
+  Parser parser{NodeAllocation::arena, m_recursion_limit};
+  return parser.genAST(s)->getFingerprint(commutative);
+}
+
+void Interpreter::setRecursionLimit(std::uint32_t limit) { m_recursion_limit = limit; }
+
+void Interpreter::setProgramCache(ProgramCache *cache) { m_cache = cache; }
+
 const SymbolTable &Interpreter::getSymbolTable() const { return m_symbol_table; }
 
 void Interpreter::reset() {
@@ -1,128 +1,186 @@
 #include "Lexer.hpp"
 #include "Errors.hpp"
 #include "tokens.hpp"
-#include <cctype>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
 
-Lexer::Lexer(std::istringstream &&ss)
-    : m_iss(std::move(ss)), m_buffer(""), m_postion(0), m_line(0), m_cur_token(getToken()) {}
+namespace {
+struct Keyword {
+  std::string_view m_text{};
+  Token m_token{Token::Id};
+};
 
-const TokenData Lexer::getCurrentToken() const { return m_cur_token; }
+/**
+ * @brief
+ * every reserved word and the token it lexes to
+ */
+const constexpr std::array<Keyword, 19> keywords{{
+    {"sin", Token::Sin},
+    {"cos", Token::Cos},
+    {"tan", Token::Tan},
+    {"asin", Token::Asin},
+    {"acos", Token::Acos},
+    {"atan", Token::Atan},
+    {"log", Token::Log},
+    {"sqrt", Token::Sqrt},
+    {"Int", Token::Int},
+    {"equal_to", Token::Equal_to},
+    {"not_equal_to", Token::Not_equal_to},
+    {"less_than", Token::Less_than},
+    {"greater_than", Token::Greater_than},
+    {"true", Token::True},
+    {"false", Token::False},
+    {"and", Token::And},
+    {"or", Token::Or},
+    {"not", Token::Not},
+    {"var", Token::Var},
+}};
 
-void Lexer::advance() {
-  if (m_tokenBuffer.empty()) {
-    m_cur_token = getToken();
-  } else {
-    m_cur_token = m_tokenBuffer.top();
-    m_tokenBuffer.pop();
-  }
-};
+const constexpr std::size_t keyword_table_bits{6};
+const constexpr std::size_t keyword_table_size{std::size_t{1} << keyword_table_bits};
 
-const TokenData Lexer::getToken() {
-  m_buffer.clear();
-  int c = m_iss.get();
-  if (c == '\n') {
-    ++m_line;
-    m_postion = 0;
-  } else {
-    ++m_postion;
+/**
+ * @brief
+ * hash an identifier from its length and first, second and last characters
+ * @param text non empty identifier
+ * @param seed multiplier searched for at compile time
+ * @return std::size_t slot in the keyword table
+ */
+constexpr std::size_t keywordHash(std::string_view text, std::uint32_t seed) {
+  auto h{static_cast<std::uint32_t>(text.size())};
+  h = h * seed + static_cast<unsigned char>(text.front());
+  h = h * seed + static_cast<unsigned char>(text[text.size() > 1 ? 1 : 0]);
+  h = h * seed + static_cast<unsigned char>(text.back());
+  return (h * std::uint32_t{2654435769u}) >> (32 - keyword_table_bits);
+}
+
+constexpr bool isPerfect(std::uint32_t seed) {
+  std::array<bool, keyword_table_size> used{};
+  for (const auto &keyword : keywords) {
+    auto slot{keywordHash(keyword.m_text, seed)};
+    if (used[slot]) {
+      return false;
+    }
+    used[slot] = true;
   }
-  while (std::isspace(c)) {
-    c = m_iss.get();
-    if (c == '\n') {
-      ++m_line;
-      m_postion = 0;
-    } else {
-      ++m_postion;
+  return true;
+}
+
+constexpr std::uint32_t findSeed() {
+  for (std::uint32_t seed = 1; seed < 10000; ++seed) {
+    if (isPerfect(seed)) {
+      return seed;
     }
   }
-  if (!m_iss) {
-    return {Token::EOF_sym, m_postion, m_line, m_buffer};
+  return 0;
+}
+
+const constexpr std::uint32_t keyword_seed{findSeed()};
+static_assert(keyword_seed != 0, "no perfect hash found for the keyword table");
+
+constexpr std::array<Keyword, keyword_table_size> makeKeywordTable() {
+  std::array<Keyword, keyword_table_size> table{};
+  for (const auto &keyword : keywords) {
+    table[keywordHash(keyword.m_text, keyword_seed)] = keyword;
   }
-  if (std::isalpha(c)) {
-    m_buffer.push_back(static_cast<char>(c));
-    c = m_iss.get();
-    ++m_postion;
-    while (std::isalnum(c) || c == '_') {
-      m_buffer.push_back(static_cast<char>(c));
-      c = m_iss.get();
-      ++m_postion;
-    }
-    m_iss.putback(static_cast<char>(c));
-    --m_postion;
-
-    Token out{};
-
-    if (m_buffer == "sin") {
-      out = Token::Sin;
-    } else if (m_buffer == "cos") {
-      out = Token::Cos;
-    } else if (m_buffer == "tan") {
-      out = Token::Tan;
-    } else if (m_buffer == "asin") {
-      out = Token::Asin;
-    } else if (m_buffer == "acos") {
-      out = Token::Acos;
-    } else if (m_buffer == "atan") {
-      out = Token::Atan;
-    } else if (m_buffer == "log") {
-      out = Token::Log;
-    } else if (m_buffer == "sqrt") {
-      out = Token::Sqrt;
-    } else if (m_buffer == "Int") {
-      out = Token::Int;
-    } else if (m_buffer == "equal_to") {
-      out = Token::Equal_to;
-    } else if (m_buffer == "not_equal_to") {
-      out = Token::Not_equal_to;
-    } else if (m_buffer == "less_than") {
-      out = Token::Less_than;
-    } else if (m_buffer == "greater_than") {
-      out = Token::Greater_than;
-    } else if (m_buffer == "true") {
-      out = Token::True;
-    } else if (m_buffer == "false") {
-      out = Token::False;
-    } else if (m_buffer == "and") {
-      out = Token::And;
-    } else if (m_buffer == "or") {
-      out = Token::Or;
-    } else if (m_buffer == "not") {
-      out = Token::Not;
-    } else if (m_buffer == "var") {
-      out = Token::Var;
-    } else {
-      // must be an identifier
-      out = Token::Id;
+  return table;
+}
+
+const constexpr std::array<Keyword, keyword_table_size> keyword_table{makeKeywordTable()};
+
+/**
+ * @brief
+ * classify an identifier shaped lexeme with a single string comparison
+ * @param text
+ * @return Token keyword token or Token::Id
+ */
+Token lookupKeyword(std::string_view text) {
+  const auto &slot{keyword_table[keywordHash(text, keyword_seed)]};
+  if (slot.m_text == text) {
+    return slot.m_token;
+  }
+  // must be an identifier
+  return Token::Id;
+}
+
+} // namespace
+
+Lexer::Lexer(std::string_view source, SourceLocation origin, const Scanner &scanner)
+    : m_source(source), m_origin(origin), m_scanner(scanner), m_offset(0), m_line(0) {
+  if (m_source.size() > std::numeric_limits<std::uint32_t>::max()) {
+    throw LexicalError{"source is too large", m_origin};
+  }
+  m_cur_token = getToken();
+}
+
+const TokenData &Lexer::getCurrentToken() const { return m_cur_token; }
+
+std::string_view Lexer::getText(const TokenData &token) const { return token.getText(m_source); }
+
+SourceLocation Lexer::getLocation(const TokenData &token) const {
+  return token.getLocation(m_line_starts, m_origin);
+}
+
+void Lexer::advance() { m_cur_token = getToken(); }
+
+TokenBuffer Lexer::tokenize() {
+  TokenBuffer tokens{m_source, m_origin};
+  // generated source averages a token every few characters
+  tokens.reserve(m_source.size() / 4 + 1);
+  tokens.push(m_cur_token);
+  try {
+    while (m_cur_token.m_token != Token::EOF_sym) {
+      m_cur_token = getToken();
+      tokens.push(m_cur_token);
     }
+  } catch (const LexicalError &error) {
+    tokens.setError(error);
+  }
+  tokens.setLineStarts(std::move(m_line_starts));
+  return tokens;
+}
 
-    return {out, m_postion, m_line, m_buffer};
+const TokenData Lexer::getToken() {
+  const char *const source{m_source.data()};
+  const char *const last{source + m_source.size()};
+  const char *newline{source + m_offset};
+
+  // skip whitespace, recording where each new line starts
+  const char *const start{m_scanner.m_skip_whitespace(newline, last)};
+  while ((newline = std::find(newline, start, '\n')) != start) {
+    ++newline;
+    ++m_line;
+    m_line_starts.push_back(static_cast<std::uint32_t>(newline - source));
+  }
+  const auto offset{static_cast<std::uint32_t>(start - source)};
+
+  if (start == last) {
+    m_offset = m_source.size();
+    return {Token::EOF_sym, offset, 0, m_line};
+  }
+  const char c{*start};
+  const char *end{start + 1};
+
+  if (hasCharClass(c, char_alpha)) {
+    end = m_scanner.m_skip_identifier(end, last);
+    m_offset = static_cast<std::size_t>(end - source);
+    const std::string_view text{start, static_cast<std::size_t>(end - start)};
+
+    return {lookupKeyword(text), offset, static_cast<std::uint32_t>(text.size()), m_line};
   }
   // number or decimal
-  if (std::isdigit(c)) {
-    m_buffer.push_back(static_cast<char>(c));
-    c = m_iss.get();
-    ++m_postion;
-    while (std::isdigit(c)) {
-      m_buffer.push_back(static_cast<char>(c));
-      c = m_iss.get();
-      ++m_postion;
-    }
+  if (hasCharClass(c, char_digit)) {
+    end = m_scanner.m_skip_digits(end, last);
     // decimal point found
-    if (c == '.') {
-      m_buffer.push_back(static_cast<char>(c));
-      c = m_iss.get();
-      ++m_postion;
-      while (std::isdigit(c)) {
-        m_buffer.push_back(static_cast<char>(c));
-        c = m_iss.get();
-        ++m_postion;
-      }
+    if (end != last && *end == '.') {
+      end = m_scanner.m_skip_digits(end + 1, last);
     }
-    m_iss.putback(static_cast<char>(c));
-    --m_postion;
-    return {Token::Number, m_postion, m_line, m_buffer};
+    m_offset = static_cast<std::size_t>(end - source);
+    return {Token::Number, offset, static_cast<std::uint32_t>(end - start), m_line};
   }
-  m_buffer.push_back(static_cast<char>(c));
+  m_offset = static_cast<std::size_t>(end - source);
   switch (c) {
   case '=':
   case '+':
@@ -134,15 +192,9 @@ const TokenData Lexer::getToken() {
   case '(':
   case ')':
   case ';':
-    return {Token(c), m_postion, m_line, m_buffer};
+    return {Token(c), offset, 1, m_line};
   }
 
-  std::string out{"Line: "};
-  out.append(std::to_string(m_line));
-  out.append(" Postion: ");
-  out.append(std::to_string(m_postion));
-
-  throw LexicalError{m_buffer, out};
+  const TokenData bad_token{Token::Id, offset, 1, m_line};
+  throw LexicalError{getText(bad_token), getLocation(bad_token)};
 }
-
-void Lexer::pushBackToken(TokenData token) { m_tokenBuffer.push(token); }
@@ -0,0 +1,60 @@
+#include "MappedFile.hpp"
+#include <cerrno>
+#include <system_error>
+
+#ifdef MAPPED_FILE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string &path) {
+  const int fd{::open(path.c_str(), O_RDONLY)};
+  if (fd == -1) {
+    throw std::system_error{errno, std::generic_category(), "cannot open " + path};
+  }
+  struct stat info {};
+  if (::fstat(fd, &info) == -1) {
+    const int error{errno};
+    ::close(fd);
+    throw std::system_error{error, std::generic_category(), "cannot read " + path};
+  }
+  // pipes and devices are left for the caller to read
+  if (!S_ISREG(info.st_mode)) {
+    ::close(fd);
+    return;
+  }
+  m_size = static_cast<std::size_t>(info.st_size);
+  // an empty file cannot be mapped but is still mapped as far as callers care
+  m_mapped = true;
+  if (m_size != 0) {
+    void *data{::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0)};
+    if (data == MAP_FAILED) {
+      m_size = 0;
+      m_mapped = false;
+    } else {
+      // scripts are read front to back once
+      ::madvise(data, m_size, MADV_SEQUENTIAL);
+      m_data = static_cast<const char *>(data);
+    }
+  }
+  ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if (m_data != nullptr) {
+    ::munmap(const_cast<char *>(m_data), m_size);
+  }
+}
+
+#else
+
+MappedFile::MappedFile([[maybe_unused]] const std::string &path) {}
+
+MappedFile::~MappedFile() {}
+
+#endif
+
+bool MappedFile::isMapped() const { return m_mapped; }
+
+std::string_view MappedFile::getText() const { return {m_data, m_size}; }
@@ -1,27 +1,272 @@
 #include "Node.hpp"
+#include "Bytecode.hpp"
+#include "DebugInfo.hpp"
+#include "Errors.hpp"
+#include <algorithm>
+#include <bit>
+#include <numeric>
+#include <utility>
 
-DataTypes Arithmetic::getDataType([[maybe_unused]] const SymbolTable &symbol_table) const {
-  return DataTypes::double_;
+namespace {
+
+/*hands heap memory to an arena and counts how much of it the arena holds*/
+class CountingResource : public std::pmr::memory_resource {
+private:
+  std::size_t m_bytes{};
+
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+    m_bytes += bytes;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+  void do_deallocate(void *pointer, std::size_t bytes, std::size_t alignment) override {
+    m_bytes -= bytes;
+    std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+  }
+  bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+
+public:
+  std::size_t getBytes() const { return m_bytes; }
+};
+
+/*the finaliser of MurmurHash3, every bit of the input affects every bit of the output*/
+std::uint64_t finalise(std::uint64_t word) {
+  word ^= word >> 33;
+  word *= 0xff51afd7ed558ccdULL;
+  word ^= word >> 33;
+  word *= 0xc4ceb9fe1a85ec53ULL;
+  word ^= word >> 33;
+  return word;
 }
 
-DataTypes Boolean::getDataType([[maybe_unused]] const SymbolTable &symbol_table) const {
-  return DataTypes::bool_;
+/*an expression being walked and the next of its operands to visit*/
+struct WalkFrame {
+  const Expression *m_expression;
+  std::size_t m_next;
+};
+
+/*bytes of text Program::print holds before writing them*/
+const constexpr std::size_t print_buffer_size{1 << 16};
+
+} // namespace
+
+struct Program::Arena {
+  CountingResource m_upstream{};
+  std::pmr::monotonic_buffer_resource m_nodes{&m_upstream};
+};
+
+Fingerprint Fingerprint::mix(std::uint64_t word) const {
+  // the halves are mixed with different constants and feed each other so they stay independent
+  const auto high{finalise(m_high ^ (word * 0x9e3779b97f4a7c15ULL)) ^ std::rotl(m_low, 29)};
+  const auto low{finalise(m_low + word + 0x632be59bd9b4e019ULL) + high};
+  return {high, low};
+}
+
+Fingerprint Fingerprint::mix(const Fingerprint &other) const {
+  return mix(other.m_high).mix(other.m_low);
 }
 
-void Program::append(std::unique_ptr<Statement> &&s) { m_statements.push_back(std::move(s)); }
+std::uint64_t Fingerprint::hashText(std::string_view text) {
+  // FNV-1a, unlike std::hash it is the same everywhere
+  std::uint64_t hash{0xcbf29ce484222325ULL};
+  for (const auto c : text) {
+    hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+Fingerprint Expression::getFingerprint(bool commutative,
+                                       std::vector<Fingerprint> *subtrees) const {
+  std::vector<WalkFrame> frames{};
+  std::vector<Fingerprint> values{};
+  // most statements fit without growing
+  frames.reserve(32);
+  values.reserve(32);
+  frames.push_back({this, 0});
+  while (!frames.empty()) {
+    auto &frame{frames.back()};
+    const auto count{frame.m_expression->getOperandCount()};
+    if (frame.m_next < count) {
+      const auto operand{frame.m_expression->getOperand(frame.m_next++)};
+      const Expression *next{operand.m_arithmetic};
+      frames.push_back({next ? next : operand.m_boolean, 0});
+      continue;
+    }
+    const auto label{frame.m_expression->getLabel()};
+    frames.pop_back();
+    // the fingerprint of the operand of a wrapper stands for the wrapper
+    if (label.m_transparent) {
+      continue;
+    }
+    const auto operands{values.end() - static_cast<std::ptrdiff_t>(count)};
+    if (commutative && label.m_commutative && operands[1] < operands[0]) {
+      std::swap(operands[0], operands[1]);
+    }
+    auto fingerprint{Fingerprint{}.mix(label.m_kind).mix(label.m_value)};
+    for (auto i = operands; i != values.end(); ++i) {
+      fingerprint = fingerprint.mix(*i);
+    }
+    values.erase(operands, values.end());
+    values.push_back(fingerprint);
+    if (subtrees) {
+      subtrees->push_back(fingerprint);
+    }
+  }
+  return values.back();
+}
 
-std::string Program::toString(const bool braces) const {
+std::string Node::toString(const bool braces) const {
   std::string out{};
+  print(out, braces);
+  return out;
+}
+
+void Expression::print(std::string &out, const bool braces) const {
+  std::vector<WalkFrame> frames{{this, 0}};
+  while (!frames.empty()) {
+    auto &frame{frames.back()};
+    const auto count{frame.m_expression->getOperandCount()};
+    frame.m_expression->printPart(out, frame.m_next, braces);
+    if (frame.m_next < count) {
+      const auto operand{frame.m_expression->getOperand(frame.m_next++)};
+      const Expression *next{operand.m_arithmetic};
+      frames.push_back({next ? next : operand.m_boolean, 0});
+      continue;
+    }
+    frames.pop_back();
+  }
+}
+
+std::size_t Expression::getOperandCount() const { return 0; }
+
+Operand Expression::getOperand([[maybe_unused]] std::size_t index) const { return {}; }
+
+void Expression::releaseOperands([[maybe_unused]] std::vector<NodePtr<Expression>> &operands) {}
+
+NodeAllocator::NodeAllocator(std::pmr::memory_resource *arena, DebugInfo *debug_info)
+    : m_arena(arena), m_debug_info(debug_info) {}
+
+DebugInfo &NodeAllocator::getDebugInfo() const { return *m_debug_info; }
+
+Program::Program(NodeAllocation allocation) : m_code(std::make_unique<Bytecode>()) {
+  if (allocation == NodeAllocation::arena) {
+    m_arenas.push_back(std::make_unique<Arena>());
+  }
+  m_debug_infos.push_back(std::make_unique<DebugInfo>());
+  m_debug_starts.push_back(0);
+}
+
+Program::~Program() = default;
+
+NodeAllocator Program::getAllocator() const {
+  return {m_arenas.empty() ? nullptr : &m_arenas.front()->m_nodes, m_debug_infos.front().get()};
+}
+
+const DebugInfo &Program::getDebugInfo(std::size_t statement) const {
+  const auto next{std::upper_bound(m_debug_starts.begin(), m_debug_starts.end(), statement)};
+  return *m_debug_infos[static_cast<std::size_t>(next - m_debug_starts.begin()) - 1];
+}
+
+void Program::append(NodePtr<Statement> &&s) {
+  s->compile(*m_code);
+  m_statements.push_back(std::move(s));
+}
+
+void Program::append(Program &&other) {
+  for (std::size_t i = 0; i < other.m_debug_infos.size(); ++i) {
+    m_debug_infos.push_back(std::move(other.m_debug_infos[i]));
+    m_debug_starts.push_back(m_statements.size() + other.m_debug_starts[i]);
+  }
+  other.m_debug_infos.clear();
+  other.m_debug_starts.clear();
+  for (auto &i : other.m_statements) {
+    m_statements.push_back(std::move(i));
+  }
+  other.m_statements.clear();
+  for (auto &i : other.m_arenas) {
+    m_arenas.push_back(std::move(i));
+  }
+  other.m_arenas.clear();
+  m_code->append(*other.m_code);
+  *other.m_code = Bytecode{};
+  // optimizing again is harmless for the part already optimized
+  m_optimization = std::min(m_optimization, other.m_optimization);
+  m_optimized = m_optimized || other.m_optimized;
+}
+
+std::size_t Program::optimize(Optimization level) {
+  std::size_t removed{};
+  if (m_optimization < Optimization::fold && level >= Optimization::fold) {
+    removed += m_code->fold();
+  }
+  if (m_optimization < Optimization::reduce && level >= Optimization::reduce) {
+    removed += m_code->reduce();
+  }
+  if (m_optimization < Optimization::reuse && level >= Optimization::reuse) {
+    removed += m_code->reuse();
+  }
+  m_optimization = std::max(m_optimization, level);
+  m_optimized = m_optimized || m_optimization != Optimization::none;
+  return removed;
+}
+
+void Program::print(std::string &out, const bool braces) const {
   for (const auto &i : m_statements) {
-    out.append(i->toString(braces));
+    i->print(out, braces);
   }
-  return out;
 }
 
-std::string Program::eval(SymbolTable &symbol_table) const {
+void Program::print(std::ostream &out, const bool braces) const {
   std::string buffer{};
   for (const auto &i : m_statements) {
-    buffer.append(i->evalGetString(symbol_table));
+    i->print(buffer, braces);
+    if (buffer.size() >= print_buffer_size) {
+      out << buffer;
+      buffer.clear();
+    }
+  }
+  out << buffer;
+}
+
+std::string Program::eval(SymbolTable &symbol_table) const {
+  std::string buffer{};
+  Fault fault{};
+  if (!eval(symbol_table, buffer, fault)) {
+    fault.raise();
   }
   return buffer;
-}
\ No newline at end of file
+}
+
+Fingerprint Program::getFingerprint(bool commutative, std::vector<Fingerprint> *subtrees) const {
+  if (!m_optimized) {
+    return m_code->getFingerprint(commutative, subtrees);
+  }
+  // optimizing loses the structure so the statements are compiled again as they were parsed
+  Bytecode code{};
+  for (const auto &i : m_statements) {
+    i->compile(code);
+  }
+  return code.getFingerprint(commutative, subtrees);
+}
+
+bool Program::eval(SymbolTable &symbol_table, std::string &out, Fault &fault) const {
+  std::size_t statement{};
+  // instructions only know their debug index, the location is looked up once something fails
+  if (!m_code->run(symbol_table, out, fault, statement)) {
+    fault.locate(getDebugInfo(statement));
+    return false;
+  }
+  return true;
+}
+
+std::size_t Program::getMemoryUsage() const {
+  const auto arenas{std::accumulate(
+      m_arenas.begin(), m_arenas.end(), std::size_t{},
+      [](std::size_t sum, const auto &arena) { return sum + arena->m_upstream.getBytes(); })};
+  const auto debug_infos{std::accumulate(
+      m_debug_infos.begin(), m_debug_infos.end(), std::size_t{},
+      [](std::size_t sum, const auto &debug_info) { return sum + debug_info->getMemoryUsage(); })};
+  return arenas + debug_infos + m_statements.capacity() * sizeof(NodePtr<Statement>) +
+         m_code->getMemoryUsage();
+}
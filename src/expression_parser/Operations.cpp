@@ -0,0 +1,234 @@
+#include "Operations.hpp"
+#include "Errors.hpp"
+#include "common.hpp"
+#include <array>
+#include <cfenv>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#if !(math_errhandling & MATH_ERREXCEPT)
+#error "no floating point exceptions"
+#endif
+
+double applyBinary(const ActionTokenData &token, double left, double right, Fault &fault) {
+  double result{};
+  const auto debug{token.getDebugIndex()};
+
+  std::feclearexcept(FE_ALL_EXCEPT);
+  switch (token.getToken()) {
+  case ActionTokens::Addition: {
+    result = left + right;
+    break;
+  }
+  case ActionTokens::Subtraction: {
+    result = left - right;
+    break;
+  }
+  case ActionTokens::Multiplication: {
+    result = left * right;
+    break;
+  }
+  case ActionTokens::Division: {
+    result = left / right;
+    if (std::fetestexcept(FE_INVALID) || std::fetestexcept(FE_DIVBYZERO) || std::isnan(result) ||
+        std::isinf(result)) {
+      fault.record(ErrorCode::domain, "Bad divide operation", debug);
+    }
+    break;
+  }
+  case ActionTokens::Modulo: {
+    result = std::fmod(left, right);
+    if (std::fetestexcept(FE_INVALID) || std::fetestexcept(FE_DIVBYZERO) || std::isnan(result) ||
+        std::isinf(result)) {
+      fault.record(ErrorCode::domain, "Bad modulo operation", debug);
+    }
+    break;
+  }
+  case ActionTokens::Power: {
+    result = std::pow(left, right);
+    if (std::fetestexcept(FE_INVALID) || std::fetestexcept(FE_DIVBYZERO) || std::isnan(result) ||
+        std::isinf(result)) {
+      fault.record(ErrorCode::domain, "Bad power operation", debug);
+    }
+    break;
+  }
+  default: {
+    unreachable();
+  }
+  }
+  return result;
+}
+
+double applyPower(const ActionTokenData &token, double base, std::uint32_t exponent,
+                  Fault &fault) {
+  // pow gives these exactly
+  const double result{exponent == 0 ? 1 : base};
+  if (!std::isfinite(result)) {
+    return applyBinary(token, base, exponent, fault);
+  }
+  return result;
+}
+
+double applyScale(const ActionTokenData &token, double dividend, double reciprocal,
+                  Fault &fault) {
+  // the reciprocal is exact so the product rounds as the quotient does
+  const auto result{dividend * reciprocal};
+  if (!std::isfinite(result)) {
+    return applyBinary(token, dividend, 1 / reciprocal, fault);
+  }
+  return result;
+}
+
+double applyRemainder(const ActionTokenData &token, double dividend, double divisor,
+                      Fault &fault) {
+  if (!std::isfinite(dividend)) {
+    return applyBinary(token, dividend, divisor, fault);
+  }
+  // every step is exact for such a divisor, fmod keeps the sign of the dividend
+  return std::copysign(dividend - std::trunc(dividend / divisor) * divisor, dividend);
+}
+
+double applyUnary(const ActionTokenData &token, double input) {
+  switch (token.getToken()) {
+  case ActionTokens::positive:
+    return +input;
+  case ActionTokens::negative:
+    return -input;
+  default:
+    unreachable();
+  }
+}
+
+double applyFunction(const ActionTokenData &token, double input, Fault &fault) {
+  double result{};
+  const auto debug{token.getDebugIndex()};
+
+  std::feclearexcept(FE_ALL_EXCEPT);
+
+  switch (token.getToken()) {
+  case ActionTokens::sin: {
+    result = std::sin(input);
+    if (std::fetestexcept(FE_INVALID) || std::isnan(result) || std::isinf(result)) {
+      fault.record(ErrorCode::domain, "Invalid argument to sin", debug);
+    }
+    break;
+  }
+  case ActionTokens::cos: {
+    result = std::cos(input);
+    if (std::fetestexcept(FE_INVALID) || std::isnan(result) || std::isinf(result)) {
+      fault.record(ErrorCode::domain, "Invalid argument to cos", debug);
+    }
+    break;
+  }
+  case ActionTokens::tan: {
+    result = std::tan(input);
+    if (std::fetestexcept(FE_INVALID) || std::isnan(result) || std::isinf(result)) {
+      fault.record(ErrorCode::domain, "Invalid argument to tan", debug);
+    }
+    break;
+  }
+  case ActionTokens::Atan: {
+    result = std::atan(input);
+    if (std::fetestexcept(FE_INVALID) || std::isnan(result) || std::isinf(result)) {
+      fault.record(ErrorCode::domain, "Invalid argument to atan", debug);
+    }
+    break;
+  }
+  case ActionTokens::Acos: {
+    result = std::acos(input);
+    if (std::fetestexcept(FE_INVALID) || std::isnan(result) || std::isinf(result)) {
+      fault.record(ErrorCode::domain, "Invalid argument to acos", debug);
+    }
+    break;
+  }
+  case ActionTokens::Asin: {
+    result = std::asin(input);
+    if (std::fetestexcept(FE_INVALID) || std::isnan(result) || std::isinf(result)) {
+      fault.record(ErrorCode::domain, "Invalid argument to asin", debug);
+    }
+    break;
+  }
+  case ActionTokens::Log: {
+    result = std::log(input);
+    if (std::fetestexcept(FE_INVALID) || std::fetestexcept(FE_DIVBYZERO) || std::isnan(result) ||
+        std::isinf(result)) {
+      fault.record(ErrorCode::domain, "Invalid argument to log", debug);
+    }
+    break;
+  }
+  case ActionTokens::Sqrt: {
+    result = std::sqrt(input);
+    if (std::fetestexcept(FE_INVALID) || std::isnan(result) || std::isinf(result)) {
+      fault.record(ErrorCode::domain, "Invalid argument to sqrt", debug);
+    }
+    break;
+  }
+  case ActionTokens::Int: {
+    if (input < 0) {
+      result = std::ceil(input);
+    } else {
+      result = std::floor(input);
+    }
+    break;
+  }
+  default:
+    unreachable();
+  }
+
+  return result;
+}
+
+bool applyBoolean(const ActionTokenData &token, bool left, bool right) {
+  switch (token.getToken()) {
+  case ActionTokens::And:
+    return left && right;
+  case ActionTokens::Or:
+    return left || right;
+  default:
+    unreachable();
+  }
+}
+
+bool applyComparison(const ActionTokenData &token, double left, double right) {
+  switch (token.getToken()) {
+  case ActionTokens::Greater_than:
+    return left > right;
+  case ActionTokens::Less_than:
+    return left < right;
+  case ActionTokens::Equal_to:
+    return left == right;
+  case ActionTokens::Not_equal_to:
+    return left != right;
+  default:
+    unreachable();
+  }
+}
+
+void appendValue(std::string &out, const var &value) {
+  if (auto typed = std::get_if<bool>(&value)) {
+    out.append(*typed ? "true\n" : "false\n");
+    return;
+  }
+  // the shortest of fixed and scientific with 4 significant digits, as a stream prints it
+  std::array<char, 32> buffer{};
+  const auto result{std::to_chars(buffer.data(), buffer.data() + buffer.size(),
+                                  *std::get_if<double>(&value), std::chars_format::general, 4)};
+  out.append(buffer.data(), result.ptr).push_back('\n');
+}
+
+void destroyIteratively(NodePtr<Expression> &&expression) {
+  if (!expression || expression.get_deleter().m_in_arena) {
+    return;
+  }
+  std::vector<NodePtr<Expression>> pending{};
+  pending.push_back(std::move(expression));
+  while (!pending.empty()) {
+    auto node{std::move(pending.back())};
+    pending.pop_back();
+    // node is destroyed at the end of the iteration with nothing left under it
+    node->releaseOperands(pending);
+  }
+}
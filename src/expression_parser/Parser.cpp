@@ -4,353 +4,722 @@
 #include "Errors.hpp"
 #include "Lexer.hpp"
 #include "Node.hpp"
+#include "Operations.hpp"
 #include "tokens.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <exception>
 #include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
-std::unique_ptr<Program> Parser::genAST(std::string &s) {
-  m_lexer = std::make_unique<Lexer>(std::istringstream{s});
-  auto output{std::make_unique<Program>()};
+namespace {
+
+/*smaller pieces are not worth handing to another thread*/
+const constexpr std::size_t min_piece_size{1 << 14};
+/*pieces per thread so threads that finish early can take more*/
+const constexpr std::size_t pieces_per_thread{4};
+
+/*a run of whole statements and where it starts in the source*/
+struct Piece {
+  std::string_view m_text;
+  SourceLocation m_origin;
+};
+
+/**
+ * @brief
+ * split a source after semicolons into about count pieces
+ * the last piece keeps any text after the last ; so it is parsed as genAST would
+ * @param s
+ * @param count
+ * @return std::vector<Piece>
+ */
+std::vector<Piece> splitPieces(std::string_view s, std::size_t count) {
+  std::vector<Piece> pieces{};
+  const auto target{std::max(s.size() / count, std::size_t{1})};
+  SourceLocation origin{};
+  while (!s.empty()) {
+    auto end{s.find(';', std::min(target, s.size()) - 1)};
+    end = end == std::string_view::npos || pieces.size() + 1 == count ? s.size() : end + 1;
+    // the remainder may be no more than spaces which genAST would not parse as a statement
+    if (s.find_first_not_of(" \t\n\v\f\r", end) == std::string_view::npos) {
+      end = s.size();
+    }
+    const auto text{s.substr(0, end)};
+    pieces.push_back({text, origin});
+
+    const auto newlines{std::count(text.begin(), text.end(), '\n')};
+    if (newlines == 0) {
+      origin.m_postion += static_cast<std::uint32_t>(text.size());
+    } else {
+      origin.m_line += static_cast<std::uint32_t>(newlines);
+      origin.m_postion = static_cast<std::uint32_t>(text.size() - text.rfind('\n') - 1);
+    }
+    s.remove_prefix(end);
+  }
+  return pieces;
+}
+
+/*an operator found between two operands*/
+struct Infix {
+  Precedence m_precedence{Precedence::none};
+  ActionTokens m_action{};
+  bool m_left_associative{};
+};
+
+/*every token that is not an infix operator has Precedence::none which no expression accepts*/
+constexpr std::array<Infix, 256> makeInfixTable() {
+  std::array<Infix, 256> table{};
+  auto set{[&table](Token token, Precedence precedence, ActionTokens action, bool left) {
+    table[static_cast<std::uint8_t>(token)] = {precedence, action, left};
+  }};
+  set(Token::And, Precedence::boolean, ActionTokens::And, true);
+  set(Token::Or, Precedence::boolean, ActionTokens::Or, true);
+  set(Token::Equal_to, Precedence::comparison, ActionTokens::Equal_to, false);
+  set(Token::Not_equal_to, Precedence::comparison, ActionTokens::Not_equal_to, false);
+  set(Token::Greater_than, Precedence::comparison, ActionTokens::Greater_than, false);
+  set(Token::Less_than, Precedence::comparison, ActionTokens::Less_than, false);
+  set(Token::Plus, Precedence::additive, ActionTokens::Addition, true);
+  set(Token::Minus, Precedence::additive, ActionTokens::Subtraction, true);
+  set(Token::Mul, Precedence::multiplicative, ActionTokens::Multiplication, true);
+  set(Token::Div, Precedence::multiplicative, ActionTokens::Division, true);
+  set(Token::Mod, Precedence::multiplicative, ActionTokens::Modulo, true);
+  set(Token::Pow, Precedence::power, ActionTokens::Power, false);
+  return table;
+}
+
+constexpr auto infix_table{makeInfixTable()};
+
+const Infix &getInfix(Token token) { return infix_table[static_cast<std::uint8_t>(token)]; }
+
+/*the function a token names, false if it names none*/
+bool getFunction(Token token, ActionTokens &action) {
+  switch (token) {
+  case Token::Sin:
+    action = ActionTokens::sin;
+    return true;
+  case Token::Cos:
+    action = ActionTokens::cos;
+    return true;
+  case Token::Tan:
+    action = ActionTokens::tan;
+    return true;
+  case Token::Asin:
+    action = ActionTokens::Asin;
+    return true;
+  case Token::Acos:
+    action = ActionTokens::Acos;
+    return true;
+  case Token::Atan:
+    action = ActionTokens::Atan;
+    return true;
+  case Token::Log:
+    action = ActionTokens::Log;
+    return true;
+  case Token::Sqrt:
+    action = ActionTokens::Sqrt;
+    return true;
+  case Token::Int:
+    action = ActionTokens::Int;
+    return true;
+  default:
+    return false;
+  }
+}
+
+/*the right operand of an operator holds only operators binding tighter than it*/
+constexpr Precedence tighter(Precedence precedence) {
+  return static_cast<Precedence>(static_cast<std::uint8_t>(precedence) + 1);
+}
+
+} // namespace
+
+Parser::Parsed::Parsed(StaticType type) : m_type(type) {}
+
+template <typename T>
+Parser::Parsed::Parsed(NodePtr<T> &&node, StaticType type, std::uint32_t recursion_limit,
+                       std::uint32_t depth)
+    : m_type(type), m_depth(depth), m_recursion_limit(recursion_limit) {
+  // the views are found by implicit upcasts while the concrete type is still known
+  if constexpr (std::is_base_of_v<Boolean, T>) {
+    m_boolean = node.get();
+  }
+  if constexpr (std::is_base_of_v<Arithmetic, T>) {
+    m_arithmetic = node.get();
+    m_node = NodePtr<Expression>{static_cast<Arithmetic *>(node.release()), node.get_deleter()};
+  } else {
+    m_node = std::move(node);
+  }
+}
+
+Parser::Parsed::~Parsed() {
+  if (m_depth > m_recursion_limit) {
+    destroyIteratively(std::move(m_node));
+  }
+}
+
+bool Parser::Parsed::isArithmetic() const { return m_type != StaticType::bool_; }
+
+bool Parser::Parsed::isBoolean() const { return m_type != StaticType::double_; }
+
+NodePtr<Arithmetic> Parser::Parsed::takeArithmetic() {
+  const auto deleter{m_node.get_deleter()};
+  m_node.release();
+  m_boolean = nullptr;
+  return NodePtr<Arithmetic>{std::exchange(m_arithmetic, nullptr), deleter};
+}
+
+NodePtr<Boolean> Parser::Parsed::takeBoolean() {
+  const auto deleter{m_node.get_deleter()};
+  m_node.release();
+  m_arithmetic = nullptr;
+  return NodePtr<Boolean>{std::exchange(m_boolean, nullptr), deleter};
+}
+
+Parser::Parser(NodeAllocation allocation, std::uint32_t recursion_limit)
+    : m_allocation(allocation), m_recursion_limit(recursion_limit) {}
+
+std::unique_ptr<Program> Parser::genAST(std::string_view s) {
+  return genAST(Lexer{s}.tokenize());
+}
+
+std::unique_ptr<Program> Parser::genAST(TokenBuffer &&tokens) {
+  Fault fault{};
+  auto output{genAST(std::move(tokens), fault)};
+  if (!output) {
+    fault.raise();
+  }
+  return output;
+}
+
+std::unique_ptr<Program> Parser::genAST(std::string_view s, Fault &fault) {
+  TokenBuffer tokens{};
+  try {
+    tokens = Lexer{s}.tokenize();
+  } catch (const LexicalError &e) {
+    // only a source too large to lex at all, any other lexical error is kept in the tokens
+    fault = e.getFault();
+    return nullptr;
+  }
+  return genAST(std::move(tokens), fault);
+}
+
+std::unique_ptr<Program> Parser::genAST(TokenBuffer &&tokens, Fault &fault) {
+  m_tokens = std::move(tokens);
+  m_index = 0;
+  m_build = true;
+  m_pending.clear();
+  m_fault = {};
+  auto output{std::make_unique<Program>(m_allocation)};
+  m_nodes = output->getAllocator();
+  m_nodes.getDebugInfo().setSource(m_tokens.getLineStarts(), m_tokens.getOrigin(),
+                                   m_tokens.size());
+  parseProgram(output.get());
+  if (m_fault) {
+    fault = std::move(m_fault);
+    return nullptr;
+  }
+  return output;
+}
+
+std::unique_ptr<Program> Parser::genASTParallel(std::string_view s, std::size_t threads,
+                                                NodeAllocation allocation,
+                                                std::uint32_t recursion_limit) {
+  const auto count{std::min(threads * pieces_per_thread, s.size() / min_piece_size)};
+  if (threads <= 1 || count <= 1) {
+    return Parser{allocation, recursion_limit}.genAST(s);
+  }
+  const auto pieces{splitPieces(s, count)};
+  std::vector<std::unique_ptr<Program>> programs(pieces.size());
+  std::vector<std::exception_ptr> errors(pieces.size());
+  std::atomic<std::size_t> next{0};
+  // pieces after one that failed are skipped, only the first error is reported
+  std::atomic<std::size_t> first_error{pieces.size()};
+
+  auto work{[&]() {
+    for (auto i{next++}; i < pieces.size(); i = next++) {
+      if (i > first_error.load()) {
+        continue;
+      }
+      try {
+        programs[i] = Parser{allocation, recursion_limit}.genAST(
+            Lexer{pieces[i].m_text, pieces[i].m_origin}.tokenize());
+      } catch (...) {
+        errors[i] = std::current_exception();
+        auto current{first_error.load()};
+        while (i < current && !first_error.compare_exchange_weak(current, i)) {
+        }
+      }
+    }
+  }};
+  {
+    std::vector<std::jthread> workers{};
+    for (std::size_t i = 1; i < std::min(threads, pieces.size()); ++i) {
+      workers.emplace_back(work);
+    }
+    work();
+  }
+
+  if (first_error.load() != pieces.size()) {
+    std::rethrow_exception(errors[first_error.load()]);
+  }
+  auto output{std::make_unique<Program>(allocation)};
+  for (auto &program : programs) {
+    output->append(std::move(*program));
+  }
+  return output;
+}
+
+void Parser::validate(std::string_view s) { validate(Lexer{s}.tokenize()); }
+
+void Parser::validate(TokenBuffer &&tokens) {
+  m_tokens = std::move(tokens);
+  m_index = 0;
+  m_build = false;
+  m_pending.clear();
+  m_fault = {};
+  parseProgram(nullptr);
+  if (m_fault) {
+    m_fault.raise();
+  }
+}
+
+void Parser::parseProgram(Program *output) {
   do {
 
-    output->append(assignExpr());
+    auto statement{assignExpr()};
+    if (m_fault) {
+      return;
+    }
+    if (output) {
+      output->append(std::move(statement));
+    }
 
-    auto val = m_lexer->getCurrentToken();
+    auto val = getCurrentToken();
     if (val.m_token != Token::Semicolon) {
-      throw SyntaxError{"Missing semicolon", val.getLocation()};
+      fail(ErrorCode::syntax, "Missing semicolon", val);
+      return;
     }
 
-    m_lexer->advance();
-  } while (m_lexer->getCurrentToken().m_token != Token::EOF_sym);
-  return output;
+    if (!advance()) {
+      return;
+    }
+  } while (getCurrentToken().m_token != Token::EOF_sym);
 }
 
-std::unique_ptr<Statement> Parser::assignExpr() {
+NodePtr<Statement> Parser::assignExpr() {
   // get current token
-  TokenData t_initial = m_lexer->getCurrentToken();
+  TokenData t_initial = getCurrentToken();
 
   if (t_initial.getToken() == Token::Var) {
 
     // move to next token should be a variable
-    m_lexer->advance();
-    TokenData token_identifier = m_lexer->getCurrentToken();
-    std::string text = token_identifier.getText();
+    if (!advance()) {
+      return nullptr;
+    }
+    TokenData token_identifier = getCurrentToken();
     if (token_identifier.getToken() != Token::Id) {
-      throw SyntaxError{"Missing identifier", token_identifier.getLocation()};
+      fail(ErrorCode::syntax, "Missing identifier", token_identifier);
+      return nullptr;
     }
 
     // move to next token which should be =
-    m_lexer->advance();
-    TokenData token_assign = m_lexer->getCurrentToken();
+    if (!advance()) {
+      return nullptr;
+    }
+    TokenData token_assign = getCurrentToken();
 
     if (token_assign.m_token == Token::Assign) {
-      m_lexer->advance();
-      return std::make_unique<Assignment>(booleanExpr(), std::move(token_identifier), true);
+      if (!advance()) {
+        return nullptr;
+      }
+      return makeAssignment(parseExpression(Precedence::boolean), token_identifier, true);
     } else {
-      throw SyntaxError{"Missing = after variable name", token_assign.getLocation()};
+      fail(ErrorCode::syntax, "Missing = after variable name", token_assign);
+      return nullptr;
     }
   } else if (t_initial.getToken() == Token::Id) {
 
-    // move to next token which should be an =
-    m_lexer->advance();
-    TokenData token_assignment = m_lexer->getCurrentToken();
-
-    if (token_assignment.getToken() == Token::Assign) {
-      m_lexer->advance();
-      return std::make_unique<Assignment>(booleanExpr(), std::move(t_initial), false);
-    } else {
-      // push tokens back to the lexer
-      m_lexer->pushBackToken(token_assignment);
-      m_lexer->pushBackToken(t_initial);
-      m_lexer->advance();
-      return std::make_unique<Print>(booleanExpr());
+    // an = after the identifier makes this an assignment otherwise it starts an expression
+    const auto next{peek(1)};
+    if (m_fault) {
+      return nullptr;
+    }
+    if (next == Token::Assign) {
+      if (!advance() || !advance()) {
+        return nullptr;
+      }
+      return makeAssignment(parseExpression(Precedence::boolean), t_initial, false);
     }
+    return makePrint(parseExpression(Precedence::boolean));
 
   } else {
-    return std::make_unique<Print>(booleanExpr());
+    return makePrint(parseExpression(Precedence::boolean));
   }
 }
 
-std::unique_ptr<Expression> Parser::booleanExpr() {
-  auto left = booleanUnaryExpr();
+Parser::Parsed Parser::parseExpression(Precedence min) {
+  const auto base{m_pending.size()};
+  Parsed operand{};
+  // the precedence of the operator that built operand, nothing binds tighter than a primary
+  Precedence level{};
   for (;;) {
-    TokenData token{m_lexer->getCurrentToken()};
-    std::string loc{token.getLocation()};
+    // open operators and brackets until an operand starts with a literal or variable
+    TokenData token{getCurrentToken()};
+    ActionTokens action{};
     switch (token.m_token) {
-    case Token::And: {
-      m_lexer->advance();
-      auto right = booleanUnaryExpr();
-      std::unique_ptr<Expression> temp{std::make_unique<BinaryBooleanOperation>(
-          std::move(left), ActionTokenData{token, ActionTokens::And}, std::move(right))};
-      left.swap(temp);
-      break;
+    case Token::Plus:
+    case Token::Minus: {
+      if (min > Precedence::unary) {
+        break;
+      }
+      if (!advance()) {
+        return {};
+      }
+      action = token.m_token == Token::Plus ? ActionTokens::positive : ActionTokens::negative;
+      m_pending.push_back({Continuation::unary, token, action, Precedence::unary, min, {}});
+      min = Precedence::primary;
+      continue;
     }
-    case Token::Or: {
-      m_lexer->advance();
-      auto right = booleanUnaryExpr();
-      std::unique_ptr<Expression> temp{std::make_unique<BinaryBooleanOperation>(
-          std::move(left), ActionTokenData{token, ActionTokens::Or}, std::move(right))};
-      left.swap(temp);
-      break;
+    case Token::Not: {
+      // not negates a whole comparison so it can only start an operand of and or
+      if (min > Precedence::negation) {
+        break;
+      }
+      if (!advance()) {
+        return {};
+      }
+      m_pending.push_back(
+          {Continuation::negation, token, ActionTokens::Not, Precedence::negation, min, {}});
+      min = Precedence::comparison;
+      continue;
+    }
+    case Token::Lp: {
+      if (!advance()) {
+        return {};
+      }
+      m_pending.push_back(
+          {Continuation::parentheses, token, action, Precedence::primary, min, {}});
+      min = Precedence::boolean;
+      continue;
     }
     default: {
-      return left;
+      if (!getFunction(token.m_token, action)) {
+        break;
+      }
+      if (!advance()) {
+        return {};
+      }
+      if (getCurrentToken().m_token != Token::Lp) {
+        fail(ErrorCode::syntax, "missing ( after function name", getCurrentToken());
+        return {};
+      }
+      if (!advance()) {
+        return {};
+      }
+      m_pending.push_back({Continuation::function, token, action, Precedence::primary, min, {}});
+      /*
+      currently this function is only used in arithmetic functions so
+      for now only parse arithmetic expressions
+      */
+      min = Precedence::additive;
+      continue;
+    }
+    }
+    operand = primary();
+    if (m_fault) {
+      return {};
     }
+    level = Precedence::primary;
+
+    // extend the operand with operators then complete what was waiting for it
+    for (;;) {
+      token = getCurrentToken();
+      const auto &infix{getInfix(token.m_token)};
+      // an operator that does not chain cannot take an operand built by the same precedence
+      if (infix.m_precedence >= min && infix.m_precedence <= level &&
+          (infix.m_precedence < level || infix.m_left_associative)) {
+        if (!advance()) {
+          return {};
+        }
+        m_pending.push_back({Continuation::infix, token, infix.m_action, infix.m_precedence, min,
+                             std::move(operand)});
+        min = tighter(infix.m_precedence);
+        break;
+      }
+      if (m_pending.size() == base) {
+        return operand;
+      }
+
+      auto pending{std::move(m_pending.back())};
+      m_pending.pop_back();
+      switch (pending.m_continuation) {
+      case Continuation::infix: {
+        switch (pending.m_precedence) {
+        case Precedence::boolean: {
+          operand = makeBinaryBoolean(std::move(pending.m_left), pending.m_token,
+                                      pending.m_action, std::move(operand));
+          break;
+        }
+        case Precedence::comparison: {
+          operand = makeComparison(std::move(pending.m_left), pending.m_token, pending.m_action,
+                                   std::move(operand));
+          break;
+        }
+        default: {
+          operand = makeBinaryArithmetic(std::move(pending.m_left), pending.m_token,
+                                         pending.m_action, std::move(operand));
+          break;
+        }
+        }
+        break;
+      }
+      case Continuation::unary: {
+        operand = makeUnaryArithmetic(pending.m_token, pending.m_action, std::move(operand));
+        break;
+      }
+      case Continuation::negation: {
+        operand = makeUnaryBoolean(pending.m_token, pending.m_action, std::move(operand));
+        break;
+      }
+      case Continuation::parentheses: {
+        if (getCurrentToken().m_token != Token::Rp) {
+          fail(ErrorCode::syntax, "missing ) after subexpression", pending.m_token);
+          return {};
+        }
+        if (!advance()) {
+          return {};
+        }
+        break;
+      }
+      case Continuation::function: {
+        if (getCurrentToken().m_token != Token::Rp) {
+          fail(ErrorCode::syntax, "missing ) after function argument", getCurrentToken());
+          return {};
+        }
+        if (!advance()) {
+          return {};
+        }
+        operand = makeFunction(pending.m_token, pending.m_action, std::move(operand));
+        break;
+      }
+      }
+      if (m_fault) {
+        return {};
+      }
+      level = pending.m_precedence;
+      min = pending.m_min;
     }
   }
 }
 
-std::unique_ptr<Expression> Parser::booleanUnaryExpr() {
-  TokenData token{m_lexer->getCurrentToken()};
-  std::string loc{token.getLocation()};
-  switch (token.m_token) {
-  case Token::Not: {
-    m_lexer->advance();
-    auto result = comparisonExpr();
-    return std::make_unique<UnaryBooleanOperation>(std::move(result),
-                                                   ActionTokenData{token, ActionTokens::Not});
+Parser::Parsed Parser::primary() {
+  TokenData t = getCurrentToken();
+  Parsed arg{};
+
+  switch (t.m_token) {
+  case Token::Id:
+    if (!advance()) {
+      return arg;
+    }
+    if (m_build) {
+      arg = Parsed{m_nodes.make<Variable>(addText(t), addLocation(t)), StaticType::unknown,
+                   m_recursion_limit};
+    }
+    return arg;
+    break;
+  case Token::Number: {
+    if (!advance()) {
+      return arg;
+    }
+    arg.m_type = StaticType::double_;
+    double value{};
+    if (!AtomicArithmetic::convert(m_tokens.getText(t), value)) {
+      fail(ErrorCode::syntax, "Cannot parse literal", t);
+      return arg;
+    }
+    if (m_build) {
+      arg = Parsed{m_nodes.make<AtomicArithmetic>(addText(t), value, addLocation(t)),
+                   StaticType::double_, m_recursion_limit};
+    }
+    return arg;
   }
-  default: {
-    return comparisonExpr();
+  case Token::True: {
+    if (!advance()) {
+      return arg;
+    }
+    arg.m_type = StaticType::bool_;
+    if (m_build) {
+      arg = Parsed{m_nodes.make<AtomicBoolean>(true, addLocation(t)), StaticType::bool_,
+                   m_recursion_limit};
+    }
+    return arg;
   }
+  case Token::False: {
+    if (!advance()) {
+      return arg;
+    }
+    arg.m_type = StaticType::bool_;
+    if (m_build) {
+      arg = Parsed{m_nodes.make<AtomicBoolean>(false, addLocation(t)), StaticType::bool_,
+                   m_recursion_limit};
+    }
+    return arg;
+  }
+  default:
+    fail(ErrorCode::syntax, "invalid expression", t);
+    return arg;
   }
 }
 
-std::unique_ptr<Expression> Parser::comparisonExpr() {
-  auto left = addExpr();
-  TokenData token{m_lexer->getCurrentToken()};
-  std::string loc{token.getLocation()};
-  switch (token.m_token) {
-  case Token::Equal_to: {
-    m_lexer->advance();
-    auto right = addExpr();
-    return std::make_unique<Comparision>(
-        std::move(left), ActionTokenData{token, ActionTokens::Equal_to}, std::move(right));
-  }
-  case Token::Not_equal_to: {
-    m_lexer->advance();
-    auto right = addExpr();
-    return std::make_unique<Comparision>(
-        std::move(left), ActionTokenData{token, ActionTokens::Not_equal_to}, std::move(right));
-  }
-  case Token::Greater_than: {
-    m_lexer->advance();
-    auto right = addExpr();
-    return std::make_unique<Comparision>(
-        std::move(left), ActionTokenData{token, ActionTokens::Greater_than}, std::move(right));
-  }
-  case Token::Less_than: {
-    m_lexer->advance();
-    auto right = addExpr();
-    return std::make_unique<Comparision>(
-        std::move(left), ActionTokenData{token, ActionTokens::Less_than}, std::move(right));
+TokenData Parser::getCurrentToken() const { return m_tokens.getTokenData(m_index); }
+
+Token Parser::peek(std::size_t ahead) {
+  const auto index{m_index + ahead};
+  if (index < m_tokens.size()) {
+    return m_tokens.getToken(index);
   }
-  default: {
-    return left;
+  if (const auto &error{m_tokens.getError()}) {
+    m_fault = error->getFault();
   }
+  return Token::EOF_sym;
+}
+
+bool Parser::advance() {
+  if (m_index + 1 < m_tokens.size()) {
+    ++m_index;
+  } else if (const auto &error{m_tokens.getError()}) {
+    m_fault = error->getFault();
+    return false;
   }
+  // the end of input is never passed
+  return true;
 }
 
-std::unique_ptr<Expression> Parser::addExpr() {
-  auto left = mulExpr();
-  for (;;) {
-    TokenData token{m_lexer->getCurrentToken()};
-    std::string loc{token.getLocation()};
-    switch (token.m_token) {
-    case Token::Plus: {
-      m_lexer->advance();
-      auto right = mulExpr();
-      std::unique_ptr<Expression> temp{std::make_unique<BinaryArithmeticOperation>(
-          std::move(left), ActionTokenData{token, ActionTokens::Addition}, std::move(right))};
-      left.swap(temp);
-      break;
-    }
-    case Token::Minus: {
-      m_lexer->advance();
-      auto right = mulExpr();
-      std::unique_ptr<Expression> temp{std::make_unique<BinaryArithmeticOperation>(
-          std::move(left), ActionTokenData{token, ActionTokens::Subtraction}, std::move(right))};
-      left.swap(temp);
-      break;
-    }
-    default: {
-      return left;
-    }
-    }
+void Parser::fail(ErrorCode code, std::string_view description, const TokenData &token,
+                  std::string detail) {
+  m_fault = Fault{code, description, m_tokens.getLocation(token), std::move(detail)};
+}
+
+DebugIndex Parser::addLocation(const TokenData &token) const {
+  return m_nodes.getDebugInfo().addLocation(token);
+}
+
+std::string_view Parser::addText(const TokenData &token) const {
+  return m_nodes.getDebugInfo().addText(m_tokens.getText(token));
+}
+
+ActionTokenData Parser::makeAction(const TokenData &token, ActionTokens action) const {
+  return {action, addLocation(token)};
+}
+
+NodePtr<Statement> Parser::makeAssignment(Parsed &&value, const TokenData &name,
+                                          bool create_var) const {
+  // value is empty once an error is found
+  if (!m_build || m_fault) {
+    return nullptr;
   }
+  // a statement too deep to recurse through is freed with an explicit stack
+  return m_nodes.make<Assignment>(std::move(value.m_node), addText(name), create_var,
+                                  addLocation(name), value.m_depth > m_recursion_limit);
 }
 
-std::unique_ptr<Expression> Parser::mulExpr() {
-  auto left = powExpr();
-  for (;;) {
-    TokenData token{m_lexer->getCurrentToken()};
-    std::string loc{token.getLocation()};
-    switch (m_lexer->getCurrentToken().m_token) {
-    case Token::Mul: {
-      m_lexer->advance();
-      auto right = powExpr();
-      std::unique_ptr<Expression> temp{std::make_unique<BinaryArithmeticOperation>(
-          std::move(left), ActionTokenData{token, ActionTokens::Multiplication}, std::move(right))};
-      left.swap(temp);
-      break;
-    }
-    case Token::Div: {
-      m_lexer->advance();
-      auto right = powExpr();
-      std::unique_ptr<Expression> temp{std::make_unique<BinaryArithmeticOperation>(
-          std::move(left), ActionTokenData{token, ActionTokens::Division}, std::move(right))};
-      left.swap(temp);
-      break;
-    }
-    case Token::Mod: {
-      m_lexer->advance();
-      auto right = powExpr();
-      std::unique_ptr<Expression> temp{std::make_unique<BinaryArithmeticOperation>(
-          std::move(left), ActionTokenData{token, ActionTokens::Modulo}, std::move(right))};
-      left.swap(temp);
-      break;
-    }
-    default: {
-      return left;
-    }
-    }
+NodePtr<Statement> Parser::makePrint(Parsed &&value) const {
+  if (!m_build || m_fault) {
+    return nullptr;
   }
+  return m_nodes.make<Print>(std::move(value.m_node), value.m_depth > m_recursion_limit);
 }
 
-std::unique_ptr<Expression> Parser::powExpr() {
-  auto left = unaryExpr();
-  TokenData token{m_lexer->getCurrentToken()};
-  std::string loc{token.getLocation()};
-  if (token.m_token == Token::Pow) {
-    m_lexer->advance();
-    auto right = unaryExpr();
-    return std::make_unique<BinaryArithmeticOperation>(
-        std::move(left), ActionTokenData{token, ActionTokens::Power}, std::move(right));
-  } else {
-    return left;
+Parser::Parsed Parser::makeBinaryArithmetic(Parsed &&left, const TokenData &token,
+                                            ActionTokens action, Parsed &&right) {
+  if (!left.isArithmetic() || !right.isArithmetic()) {
+    const ActionTokenData op{action};
+    std::string operation{op.getOperation()};
+    fail(ErrorCode::static_type, "Bad data type for binary arithmetic operation ", token,
+         operation.append(" "));
+    return {};
+  }
+  if (!m_build) {
+    return Parsed{StaticType::double_};
   }
+  return {m_nodes.make<BinaryArithmeticOperation>(
+              left.takeArithmetic(), makeAction(token, action), right.takeArithmetic()),
+          StaticType::double_, m_recursion_limit, std::max(left.m_depth, right.m_depth) + 1};
 }
 
-std::unique_ptr<Expression> Parser::unaryExpr() {
-  TokenData token{m_lexer->getCurrentToken()};
-  std::string loc{token.getLocation()};
-  switch (token.m_token) {
-  case Token::Plus: {
-    m_lexer->advance();
-    auto result = primary();
-    return std::make_unique<UnaryArithmeticOperation>(
-        std::move(result), ActionTokenData{token, ActionTokens::positive});
-    break;
+Parser::Parsed Parser::makeUnaryArithmetic(const TokenData &token, ActionTokens action,
+                                           Parsed &&input) {
+  if (!input.isArithmetic()) {
+    const ActionTokenData op{action};
+    fail(ErrorCode::static_type, "Bad data type for unary arithmetic operator ", token,
+         std::string{op.getOperation()});
+    return {};
   }
-  case Token::Minus: {
-    m_lexer->advance();
-    auto result = primary();
-    return std::make_unique<UnaryArithmeticOperation>(
-        std::move(result), ActionTokenData{token, ActionTokens::negative});
-    break;
+  if (!m_build) {
+    return Parsed{StaticType::double_};
   }
-  default:
-    return primary();
+  return {m_nodes.make<UnaryArithmeticOperation>(input.takeArithmetic(),
+                                                 makeAction(token, action)),
+          StaticType::double_, m_recursion_limit, input.m_depth + 1};
+}
+
+Parser::Parsed Parser::makeFunction(const TokenData &token, ActionTokens action, Parsed &&input) {
+  if (!input.isArithmetic()) {
+    fail(ErrorCode::static_type, "Bad data type when calling function", token);
+    return {};
+  }
+  if (!m_build) {
+    return Parsed{StaticType::double_};
   }
+  return {m_nodes.make<FunctionArithmetic>(input.takeArithmetic(), makeAction(token, action)),
+          StaticType::double_, m_recursion_limit, input.m_depth + 1};
 }
 
-std::unique_ptr<Expression> Parser::primary() {
-  TokenData t = m_lexer->getCurrentToken();
-  std::string text = t.getText();
-  std::unique_ptr<Expression> arg{};
-  std::string loc{t.getLocation()};
+Parser::Parsed Parser::makeBinaryBoolean(Parsed &&left, const TokenData &token,
+                                         ActionTokens action, Parsed &&right) {
+  if (!left.isBoolean() || !right.isBoolean()) {
+    fail(ErrorCode::static_type, "Bad data types for boolean operation", token);
+    return {};
+  }
+  if (!m_build) {
+    return Parsed{StaticType::bool_};
+  }
+  return {m_nodes.make<BinaryBooleanOperation>(left.takeBoolean(), makeAction(token, action),
+                                               right.takeBoolean()),
+          StaticType::bool_, m_recursion_limit, std::max(left.m_depth, right.m_depth) + 1};
+}
 
-  switch (t.m_token) {
-  case Token::Id:
-    m_lexer->advance();
-    return std::make_unique<Variable>(std::move(t));
-    break;
-  case Token::Number:
-    m_lexer->advance();
-    return std::make_unique<AtomicArithmetic>(std::move(t));
-    break;
-  case Token::True: {
-    m_lexer->advance();
-    return std::make_unique<AtomicBoolean>(std::move(t));
+Parser::Parsed Parser::makeUnaryBoolean(const TokenData &token, ActionTokens action,
+                                        Parsed &&input) {
+  if (!input.isBoolean()) {
+    fail(ErrorCode::static_type, "Bad data types for boolean operation", token);
+    return {};
   }
-  case Token::False: {
-    m_lexer->advance();
-    return std::make_unique<AtomicBoolean>(std::move(t));
-  }
-  case Token::Lp:
-    m_lexer->advance();
-    arg = booleanExpr();
-    if (m_lexer->getCurrentToken().m_token != Token::Rp) {
-      throw SyntaxError{"missing ) after subexpression", loc};
-    }
-    m_lexer->advance();
-    // we can skip Parentheses node?
-    return arg;
-    break;
-  case Token::Sin:
-    arg = getArgument();
-    return std::make_unique<FunctionArithmetic>(std::move(arg),
-                                                ActionTokenData{t, ActionTokens::sin});
-    break;
-  case Token::Cos:
-    arg = getArgument();
-    return std::make_unique<FunctionArithmetic>(std::move(arg),
-                                                ActionTokenData{t, ActionTokens::cos});
-    break;
-  case Token::Tan:
-    arg = getArgument();
-    return std::make_unique<FunctionArithmetic>(std::move(arg),
-                                                ActionTokenData{t, ActionTokens::tan});
-    break;
-  case Token::Asin:
-    arg = getArgument();
-    return std::make_unique<FunctionArithmetic>(std::move(arg),
-                                                ActionTokenData{t, ActionTokens::Asin});
-    break;
-  case Token::Acos:
-    arg = getArgument();
-    return std::make_unique<FunctionArithmetic>(std::move(arg),
-                                                ActionTokenData{t, ActionTokens::Acos});
-    break;
-  case Token::Atan:
-    arg = getArgument();
-    return std::make_unique<FunctionArithmetic>(std::move(arg),
-                                                ActionTokenData{t, ActionTokens::Atan});
-    break;
-  case Token::Log:
-    arg = getArgument();
-    return std::make_unique<FunctionArithmetic>(std::move(arg),
-                                                ActionTokenData{t, ActionTokens::Log});
-    break;
-  case Token::Sqrt:
-    arg = getArgument();
-    return std::make_unique<FunctionArithmetic>(std::move(arg),
-                                                ActionTokenData{t, ActionTokens::Sqrt});
-    break;
-  case Token::Int:
-    arg = getArgument();
-    return std::make_unique<FunctionArithmetic>(std::move(arg),
-                                                ActionTokenData{t, ActionTokens::Int});
-    break;
-  default:
-    throw SyntaxError{"invalid expression", loc};
+  if (!m_build) {
+    return Parsed{StaticType::bool_};
   }
+  return {m_nodes.make<UnaryBooleanOperation>(input.takeBoolean(), makeAction(token, action)),
+          StaticType::bool_, m_recursion_limit, input.m_depth + 1};
 }
 
-std::unique_ptr<Expression> Parser::getArgument() {
-  m_lexer->advance();
-  if (m_lexer->getCurrentToken().m_token != Token::Lp) {
-    throw SyntaxError{"missing ( after function name", m_lexer->getCurrentToken().getLocation()};
+Parser::Parsed Parser::makeComparison(Parsed &&left, const TokenData &token, ActionTokens action,
+                                      Parsed &&right) {
+  if (!left.isArithmetic() || !right.isArithmetic()) {
+    const ActionTokenData op{action};
+    std::string operation{op.getOperation()};
+    fail(ErrorCode::static_type, "Bad data type for comparison operation ", token,
+         operation.append(" "));
+    return {};
   }
-  m_lexer->advance();
-  /*
-  currently this function is only used in arithmetic functions so
-  for now only parse arithmetic expressions
-  */
-  auto arg = addExpr();
-  if (m_lexer->getCurrentToken().m_token != Token::Rp) {
-    throw SyntaxError{"missing ) after function argument",
-                      m_lexer->getCurrentToken().getLocation()};
+  if (!m_build) {
+    return Parsed{StaticType::bool_};
   }
-  m_lexer->advance();
-  return arg;
+  return {m_nodes.make<Comparision>(left.takeArithmetic(), makeAction(token, action),
+                                    right.takeArithmetic()),
+          StaticType::bool_, m_recursion_limit, std::max(left.m_depth, right.m_depth) + 1};
 }
@@ -0,0 +1,158 @@
+#include "ProgramCache.hpp"
+#include "Errors.hpp"
+#include "Parser.hpp"
+#include "Types.hpp"
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+
+/*a kept program and the source it was parsed from*/
+struct Entry {
+  std::string m_source;
+  std::uint32_t m_recursion_limit;
+  std::shared_ptr<const Program> m_program;
+  std::size_t m_bytes;
+  /*set by every hit, cleared as the hand passes, the hand evicts an entry it finds clear*/
+  std::atomic<bool> m_referenced{false};
+};
+
+} // namespace
+
+struct ProgramCache::Shard {
+  std::shared_mutex m_mutex{};
+  /*the clock the hand sweeps, entries are on the heap so the views of their sources stay valid*/
+  std::vector<std::unique_ptr<Entry>> m_entries{};
+  std::size_t m_hand{};
+  std::unordered_map<std::string_view, Entry *, SymbolHash, std::equal_to<>> m_index{};
+  std::size_t m_bytes{};
+
+  /*the entry kept for source, null if there is none*/
+  Entry *find(std::string_view source) const {
+    const auto pos{m_index.find(source)};
+    return pos == m_index.end() ? nullptr : pos->second;
+  }
+
+  /*move the hand on clearing flags until it is on an entry no one used since it last passed*/
+  void advanceHand() {
+    for (;;) {
+      m_hand = m_hand < m_entries.size() ? m_hand : 0;
+      if (!m_entries[m_hand]->m_referenced.exchange(false, std::memory_order_relaxed)) {
+        return;
+      }
+      ++m_hand;
+    }
+  }
+
+  /*drop the entry the hand is on, the last entry takes its place on the clock*/
+  void evict() {
+    auto &entry{m_entries[m_hand]};
+    m_index.erase(entry->m_source);
+    m_bytes -= entry->m_bytes;
+    entry = std::move(m_entries.back());
+    m_entries.pop_back();
+  }
+
+  /*drop one entry wherever it is*/
+  void remove(const Entry *entry) {
+    const auto pos{std::find_if(m_entries.begin(), m_entries.end(),
+                                [entry](const auto &other) { return other.get() == entry; })};
+    m_hand = static_cast<std::size_t>(pos - m_entries.begin());
+    evict();
+  }
+
+  void clear() {
+    m_entries.clear();
+    m_index.clear();
+    m_hand = 0;
+    m_bytes = 0;
+  }
+};
+
+ProgramCache::ProgramCache(std::size_t budget, std::size_t shards, Optimization optimization)
+    : m_shard_budget(budget / std::max(shards, std::size_t{1})), m_optimization(optimization) {
+  for (std::size_t i = 0; i < std::max(shards, std::size_t{1}); ++i) {
+    m_shards.push_back(std::make_unique<Shard>());
+  }
+}
+
+ProgramCache::~ProgramCache() = default;
+
+std::shared_ptr<const Program> ProgramCache::get(std::string_view source,
+                                                 std::uint32_t recursion_limit, Fault &fault) {
+  auto &shard{*m_shards[std::hash<std::string_view>{}(source) % m_shards.size()]};
+  {
+    std::shared_lock lock{shard.m_mutex};
+    if (auto *entry{shard.find(source)};
+        entry && entry->m_recursion_limit == recursion_limit) {
+      entry->m_referenced.store(true, std::memory_order_relaxed);
+      m_hits.fetch_add(1, std::memory_order_relaxed);
+      return entry->m_program;
+    }
+  }
+  m_misses.fetch_add(1, std::memory_order_relaxed);
+
+  // parsed outside the lock, threads missing the same source at once each parse it
+  Parser parser{NodeAllocation::arena, recursion_limit};
+  auto parsed{parser.genAST(source, fault)};
+  if (!parsed) {
+    return nullptr;
+  }
+  // optimized once here for every time it is run
+  parsed->optimize(m_optimization);
+  std::shared_ptr<const Program> program{std::move(parsed)};
+  const auto bytes{sizeof(Entry) + source.size() + program->getMemoryUsage()};
+  if (bytes > m_shard_budget) {
+    return program;
+  }
+
+  std::unique_lock lock{shard.m_mutex};
+  if (const auto *entry{shard.find(source)}) {
+    if (entry->m_recursion_limit == recursion_limit) {
+      return entry->m_program;
+    }
+    // kept with another limit, the latest one is more likely to be asked for again
+    shard.remove(entry);
+  }
+  while (shard.m_bytes + bytes > m_shard_budget) {
+    shard.advanceHand();
+    shard.evict();
+    m_evictions.fetch_add(1, std::memory_order_relaxed);
+  }
+  auto entry{std::make_unique<Entry>()};
+  entry->m_source = source;
+  entry->m_recursion_limit = recursion_limit;
+  entry->m_program = program;
+  entry->m_bytes = bytes;
+  shard.m_index.emplace(entry->m_source, entry.get());
+  shard.m_entries.push_back(std::move(entry));
+  shard.m_bytes += bytes;
+  return program;
+}
+
+ProgramCache::Stats ProgramCache::getStats() const {
+  Stats stats{m_hits.load(), m_misses.load(), m_evictions.load(), 0, 0};
+  for (const auto &shard : m_shards) {
+    std::shared_lock lock{shard->m_mutex};
+    stats.m_programs += shard->m_entries.size();
+    stats.m_bytes += shard->m_bytes;
+  }
+  return stats;
+}
+
+void ProgramCache::clear() {
+  for (const auto &shard : m_shards) {
+    std::unique_lock lock{shard->m_mutex};
+    shard->clear();
+  }
+}
+
+ProgramCache &ProgramCache::getGlobal() {
+  static ProgramCache cache{};
+  return cache;
+}
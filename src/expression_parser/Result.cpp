@@ -0,0 +1,41 @@
+#include "Result.hpp"
+#include "Errors.hpp"
+#include "tokens.hpp"
+#include <utility>
+
+EvalError::EvalError(ErrorCode code, std::string_view description, std::string detail,
+                     std::uint32_t line, std::uint32_t postion)
+    : m_code(code), m_description(description), m_detail(std::move(detail)), m_line(line),
+      m_postion(postion) {}
+
+ErrorCode EvalError::getCode() const { return m_code; }
+
+std::string EvalError::getDescription() const {
+  std::string out{m_description};
+  out.append(m_detail);
+  return out;
+}
+
+std::uint32_t EvalError::getLine() const { return m_line; }
+
+std::uint32_t EvalError::getPostion() const { return m_postion; }
+
+std::string EvalError::getMessage() const {
+  std::string out{getHeading(m_code)};
+  out.append(getDescription());
+  out.append(" ");
+  out.append(SourceLocation{m_line, m_postion}.toString());
+  return out;
+}
+
+EvalResult::EvalResult(std::string output) : m_value(std::move(output)) {}
+
+EvalResult::EvalResult(EvalError error) : m_value(std::move(error)) {}
+
+bool EvalResult::hasValue() const { return m_value.index() == 0; }
+
+EvalResult::operator bool() const { return hasValue(); }
+
+const std::string &EvalResult::getValue() const { return std::get<std::string>(m_value); }
+
+const EvalError &EvalResult::getError() const { return std::get<EvalError>(m_value); }
@@ -0,0 +1,174 @@
+#include "Scanner.hpp"
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SCANNER_SSE2 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(SCANNER_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#define SCANNER_AVX2 1
+#define SCANNER_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace {
+
+// runs shorter than this are finished a byte at a time before using vector registers
+const constexpr std::ptrdiff_t short_run{8};
+
+template <CharClass char_class>
+const char *skipScalar(const char *first, const char *last) {
+  while (first != last && hasCharClass(*first, char_class)) {
+    ++first;
+  }
+  return first;
+}
+
+/**
+ * @brief
+ * skip the start of a run one byte at a time, most runs in source text are short
+ * @return true if the run ended within the first short_run bytes
+ */
+template <CharClass char_class>
+bool skipShortRun(const char *&first, const char *last) {
+  const char *short_last{last - first > short_run ? first + short_run : last};
+  first = skipScalar<char_class>(first, short_last);
+  return first != short_last || first == last;
+}
+
+#if defined(SCANNER_SSE2)
+
+unsigned countTrailingZeros(unsigned mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  unsigned long index{};
+  _BitScanForward(&index, mask);
+  return static_cast<unsigned>(index);
+#else
+  return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+// lanes of x that lie in [lo, hi] using unsigned comparisons
+__m128i inRange128(__m128i x, char lo, char hi) {
+  __m128i above{_mm_cmpeq_epi8(_mm_max_epu8(x, _mm_set1_epi8(lo)), x)};
+  __m128i below{_mm_cmpeq_epi8(_mm_min_epu8(x, _mm_set1_epi8(hi)), x)};
+  return _mm_and_si128(above, below);
+}
+
+__m128i matchSse2(__m128i x, CharClass char_class) {
+  switch (char_class) {
+  case char_space:
+    return _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(' ')), inRange128(x, '\t', '\r'));
+  case char_digit:
+    return inRange128(x, '0', '9');
+  case char_identifier: {
+    // setting bit 5 folds upper case letters onto lower case
+    __m128i letters{inRange128(_mm_or_si128(x, _mm_set1_epi8(0x20)), 'a', 'z')};
+    __m128i other{_mm_or_si128(inRange128(x, '0', '9'), _mm_cmpeq_epi8(x, _mm_set1_epi8('_')))};
+    return _mm_or_si128(letters, other);
+  }
+  default:
+    return _mm_setzero_si128();
+  }
+}
+
+template <CharClass char_class>
+const char *skipSse2(const char *first, const char *last) {
+  if (skipShortRun<char_class>(first, last)) {
+    return first;
+  }
+  while (last - first >= 16) {
+    __m128i block{_mm_loadu_si128(reinterpret_cast<const __m128i *>(first))};
+    auto mask{static_cast<unsigned>(_mm_movemask_epi8(matchSse2(block, char_class)))};
+    if (mask != 0xFFFFu) {
+      return first + countTrailingZeros(~mask);
+    }
+    first += 16;
+  }
+  return skipScalar<char_class>(first, last);
+}
+
+#endif
+
+#if defined(SCANNER_AVX2)
+
+SCANNER_TARGET_AVX2 __m256i inRange256(__m256i x, char lo, char hi) {
+  __m256i above{_mm256_cmpeq_epi8(_mm256_max_epu8(x, _mm256_set1_epi8(lo)), x)};
+  __m256i below{_mm256_cmpeq_epi8(_mm256_min_epu8(x, _mm256_set1_epi8(hi)), x)};
+  return _mm256_and_si256(above, below);
+}
+
+SCANNER_TARGET_AVX2 __m256i matchAvx2(__m256i x, CharClass char_class) {
+  switch (char_class) {
+  case char_space:
+    return _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8(' ')),
+                           inRange256(x, '\t', '\r'));
+  case char_digit:
+    return inRange256(x, '0', '9');
+  case char_identifier: {
+    __m256i letters{inRange256(_mm256_or_si256(x, _mm256_set1_epi8(0x20)), 'a', 'z')};
+    __m256i other{
+        _mm256_or_si256(inRange256(x, '0', '9'), _mm256_cmpeq_epi8(x, _mm256_set1_epi8('_')))};
+    return _mm256_or_si256(letters, other);
+  }
+  default:
+    return _mm256_setzero_si256();
+  }
+}
+
+template <CharClass char_class>
+SCANNER_TARGET_AVX2 const char *skipAvx2(const char *first, const char *last) {
+  if (skipShortRun<char_class>(first, last)) {
+    return first;
+  }
+  while (last - first >= 32) {
+    __m256i block{_mm256_loadu_si256(reinterpret_cast<const __m256i *>(first))};
+    auto mask{static_cast<unsigned>(_mm256_movemask_epi8(matchAvx2(block, char_class)))};
+    if (mask != 0xFFFFFFFFu) {
+      return first + countTrailingZeros(~mask);
+    }
+    first += 32;
+  }
+  return skipSse2<char_class>(first, last);
+}
+
+#endif
+
+const constexpr Scanner scalar_scanner{skipScalar<char_space>, skipScalar<char_digit>,
+                                       skipScalar<char_identifier>, "scalar"};
+
+#if defined(SCANNER_SSE2)
+const constexpr Scanner sse2_scanner{skipSse2<char_space>, skipSse2<char_digit>,
+                                     skipSse2<char_identifier>, "sse2"};
+#endif
+
+#if defined(SCANNER_AVX2)
+const constexpr Scanner avx2_scanner{skipAvx2<char_space>, skipAvx2<char_digit>,
+                                     skipAvx2<char_identifier>, "avx2"};
+#endif
+
+const Scanner &selectScanner() {
+#if defined(SCANNER_AVX2)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return avx2_scanner;
+  }
+#endif
+#if defined(SCANNER_SSE2)
+  return sse2_scanner;
+#else
+  return scalar_scanner;
+#endif
+}
+
+} // namespace
+
+const Scanner &getScanner() {
+  static const Scanner &scanner{selectScanner()};
+  return scanner;
+}
+
+const Scanner &getScalarScanner() { return scalar_scanner; }
@@ -0,0 +1,42 @@
+#include "StatementStream.hpp"
+#include <algorithm>
+
+void StatementStream::feed(std::string_view chunk) { m_chunk = chunk; }
+
+bool StatementStream::next(std::string_view &statement, SourceLocation &origin) {
+  auto end{m_chunk.find(';')};
+  if (end == std::string_view::npos) {
+    m_carry.append(m_chunk);
+    m_chunk = {};
+    return false;
+  }
+  ++end;
+  if (m_carry.empty()) {
+    statement = m_chunk.substr(0, end);
+  } else {
+    m_carry.append(m_chunk.substr(0, end));
+    // swap so both buffers keep their capacity
+    m_statement.swap(m_carry);
+    m_carry.clear();
+    statement = m_statement;
+  }
+  m_chunk.remove_prefix(end);
+  origin = m_origin;
+  advanceOrigin(statement);
+  return true;
+}
+
+std::string_view StatementStream::rest(SourceLocation &origin) const {
+  origin = m_origin;
+  return m_carry;
+}
+
+void StatementStream::advanceOrigin(std::string_view text) {
+  const auto newlines{std::count(text.begin(), text.end(), '\n')};
+  if (newlines == 0) {
+    m_origin.m_postion += static_cast<std::uint32_t>(text.size());
+    return;
+  }
+  m_origin.m_line += static_cast<std::uint32_t>(newlines);
+  m_origin.m_postion = static_cast<std::uint32_t>(text.size() - text.rfind('\n') - 1);
+}
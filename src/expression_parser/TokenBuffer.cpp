@@ -0,0 +1,48 @@
+#include "TokenBuffer.hpp"
+
+TokenBuffer::TokenBuffer(std::string_view source, SourceLocation origin)
+    : m_source(source), m_origin(origin) {}
+
+void TokenBuffer::reserve(std::size_t tokens) {
+  m_tokens.reserve(tokens);
+  m_offsets.reserve(tokens);
+  m_lengths.reserve(tokens);
+  m_lines.reserve(tokens);
+}
+
+void TokenBuffer::push(const TokenData &token) {
+  m_tokens.push_back(token.getToken());
+  m_offsets.push_back(token.getOffset());
+  m_lengths.push_back(token.getLength());
+  m_lines.push_back(token.getLine());
+}
+
+void TokenBuffer::setLineStarts(std::vector<std::uint32_t> &&line_starts) {
+  m_line_starts = std::move(line_starts);
+}
+
+void TokenBuffer::setError(const LexicalError &error) { m_error = error; }
+
+std::size_t TokenBuffer::size() const { return m_tokens.size(); }
+
+std::string_view TokenBuffer::getSource() const { return m_source; }
+
+const SourceLocation &TokenBuffer::getOrigin() const { return m_origin; }
+
+const std::vector<std::uint32_t> &TokenBuffer::getLineStarts() const { return m_line_starts; }
+
+Token TokenBuffer::getToken(std::size_t index) const { return m_tokens[index]; }
+
+TokenData TokenBuffer::getTokenData(std::size_t index) const {
+  return {m_tokens[index], m_offsets[index], m_lengths[index], m_lines[index]};
+}
+
+const std::optional<LexicalError> &TokenBuffer::getError() const { return m_error; }
+
+std::string_view TokenBuffer::getText(const TokenData &token) const {
+  return token.getText(m_source);
+}
+
+SourceLocation TokenBuffer::getLocation(const TokenData &token) const {
+  return token.getLocation(m_line_starts, m_origin);
+}
@@ -0,0 +1,145 @@
+#include "Worksheet.hpp"
+#include "Errors.hpp"
+#include "Lexer.hpp"
+#include "Parser.hpp"
+#include "Scanner.hpp"
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+bool isBlank(std::string_view text) {
+  return std::all_of(text.begin(), text.end(), [](char c) { return hasCharClass(c, char_space); });
+}
+
+} // namespace
+
+Worksheet::Worksheet() = default;
+
+void Worksheet::replaceLines(std::size_t first, std::size_t count,
+                             const std::vector<std::string> &lines) {
+  first = std::min(first, m_lines.size());
+  count = std::min(count, m_lines.size() - first);
+  const auto begin{m_lines.begin() + static_cast<std::ptrdiff_t>(first)};
+  for (auto it = begin; it != begin + static_cast<std::ptrdiff_t>(count); ++it) {
+    m_error_count -= it->m_has_error ? 1 : 0;
+  }
+
+  // reuse the replaced slots before shifting the lines after them
+  const auto reused{std::min(count, lines.size())};
+  if (count > lines.size()) {
+    m_lines.erase(begin + static_cast<std::ptrdiff_t>(reused),
+                  begin + static_cast<std::ptrdiff_t>(count));
+  } else if (count < lines.size()) {
+    std::vector<Line> added(lines.size() - count);
+    m_lines.insert(begin + static_cast<std::ptrdiff_t>(count),
+                   std::make_move_iterator(added.begin()), std::make_move_iterator(added.end()));
+  }
+  for (std::size_t i = 0; i < lines.size(); ++i) {
+    auto &line{m_lines[first + i]};
+    line.m_text = lines[i];
+    parseLine(line);
+    m_error_count += line.m_has_error ? 1 : 0;
+  }
+}
+
+void Worksheet::setText(std::string_view text) {
+  std::vector<std::string> lines{};
+  for (;;) {
+    const auto end{text.find('\n')};
+    lines.emplace_back(text.substr(0, end));
+    if (end == std::string_view::npos) {
+      break;
+    }
+    text.remove_prefix(end + 1);
+  }
+  replaceLines(0, m_lines.size(), lines);
+}
+
+std::size_t Worksheet::getLineCount() const { return m_lines.size(); }
+
+std::size_t Worksheet::getErrorCount() const { return m_error_count; }
+
+const Program *Worksheet::getProgram(std::size_t line) const {
+  return m_lines[line].m_program.get();
+}
+
+std::vector<Worksheet::Diagnostic> Worksheet::getDiagnostics(std::size_t first,
+                                                             std::size_t count) const {
+  std::vector<Diagnostic> out{};
+  const auto last{std::min(m_lines.size(), first + count)};
+  for (auto i = first; i < last; ++i) {
+    const auto &line{m_lines[i]};
+    if (line.m_has_error) {
+      out.push_back({i, line.m_postion, line.m_message});
+    }
+  }
+  return out;
+}
+
+std::vector<Worksheet::Diagnostic> Worksheet::getDiagnostics() const {
+  return getDiagnostics(0, m_lines.size());
+}
+
+void Worksheet::setRecursionLimit(std::uint32_t limit) {
+  if (limit == m_recursion_limit) {
+    return;
+  }
+  m_recursion_limit = limit;
+  m_error_count = 0;
+  for (auto &line : m_lines) {
+    parseLine(line);
+    m_error_count += line.m_has_error ? 1 : 0;
+  }
+}
+
+std::string Worksheet::eval(SymbolTable &symbol_table) const {
+  if (m_error_count != 0) {
+    const auto it{std::find_if(m_lines.begin(), m_lines.end(),
+                               [](const Line &line) { return line.m_has_error; })};
+    const SourceLocation location{static_cast<std::uint32_t>(it - m_lines.begin()),
+                                  it->m_postion};
+    Fault{it->m_code, {}, location, it->m_message}.raise();
+  }
+  std::string out{};
+  for (std::size_t i = 0; i < m_lines.size(); ++i) {
+    const auto *program{m_lines[i].m_program.get()};
+    if (!program) {
+      continue;
+    }
+    // lines are parsed on their own so their locations are moved to where the line is now
+    if (Fault fault{}; !program->eval(symbol_table, out, fault)) {
+      fault.m_location.m_line = static_cast<std::uint32_t>(i);
+      fault.raise();
+    }
+  }
+  return out;
+}
+
+void Worksheet::parseLine(Line &line) {
+  line.m_program.reset();
+  line.m_has_error = false;
+  line.m_code = ErrorCode::none;
+  line.m_message.clear();
+  if (isBlank(line.m_text)) {
+    return;
+  }
+  std::string source{line.m_text};
+  const auto last{source.find_last_not_of(" \t\v\f\r")};
+  if (source[last] != ';') {
+    source.push_back(';');
+  }
+  // lines with errors are common while typing so they are reported without throwing
+  Parser parser{NodeAllocation::heap, m_recursion_limit};
+  Fault fault{};
+  line.m_program = parser.genAST(source, fault);
+  if (!line.m_program) {
+    line.m_has_error = true;
+    line.m_code = fault.m_code;
+    line.m_postion = fault.m_location.m_postion;
+    line.m_message = fault.getDescription();
+    return;
+  }
+  // a line is run on every evaluation until it is edited
+  line.m_program->optimize(Optimization::fold);
+}
@@ -2,170 +2,214 @@
 #define AST_HPP
 
 #include "ActionTokens.hpp"
+#include "DebugInfo.hpp"
 #include "Node.hpp"
 #include "Types.hpp"
 #include "tokens.hpp"
 #include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 
+/*
+the text of a node is kept in the debug info it was made with, which outlives the node
+*/
 class Variable : public Arithmetic, public Boolean {
 private:
-  TokenData m_token;
+  std::string_view m_name;
+  DebugIndex m_debug;
 
 public:
-  Variable(TokenData &&token);
-  virtual std::string toString(const bool braces) const override;
-  virtual double evalGetDouble(const SymbolTable &symbol_table) const override;
-  virtual bool evalGetBool(const SymbolTable &symbol_table) const override;
-  virtual var eval(const SymbolTable &symbol_table) const override;
-  virtual DataTypes getDataType(const SymbolTable &symbol_table) const override;
+  Variable(std::string_view name, DebugIndex debug = no_debug_info);
+  virtual void printPart(std::string &out, std::size_t part, const bool braces) const override;
+  virtual void compile(Bytecode &code, const Operand &as) const override;
+  virtual NodeLabel getLabel() const override;
 };
 
 class AtomicArithmetic : public Arithmetic {
 private:
-  TokenData m_token;
+  double m_value{};
+  std::string_view m_text;
+  DebugIndex m_debug;
 
 public:
-  AtomicArithmetic(TokenData &&token);
-  virtual std::string toString(const bool braces) const override;
-  virtual double evalGetDouble(const SymbolTable &symbol_table) const override;
-  virtual var eval(const SymbolTable &symbol_table) const override;
+  AtomicArithmetic(std::string_view text, DebugIndex debug = no_debug_info);
+  /*value is the text already converted*/
+  AtomicArithmetic(std::string_view text, double value, DebugIndex debug);
+  /*convert the text of a literal, false if it is malformed or out of range*/
+  static bool convert(std::string_view text, double &value);
+  virtual void printPart(std::string &out, std::size_t part, const bool braces) const override;
+  virtual void compile(Bytecode &code, const Operand &as) const override;
+  virtual NodeLabel getLabel() const override;
 };
 
 class ParenthesesArithmetic : public Arithmetic {
 private:
-  TokenData m_token;
-  std::unique_ptr<Arithmetic> m_input;
+  DebugIndex m_debug;
+  NodePtr<Arithmetic> m_input;
 
 public:
-  ParenthesesArithmetic(std::unique_ptr<Expression> &&input, TokenData &&token);
-  virtual std::string toString(const bool braces) const override;
-  virtual double evalGetDouble(const SymbolTable &symbol_table) const override;
-  virtual var eval(const SymbolTable &symbol_table) const override;
+  ParenthesesArithmetic(NodePtr<Arithmetic> &&input, DebugIndex debug = no_debug_info);
+  virtual void printPart(std::string &out, std::size_t part, const bool braces) const override;
+  virtual void compile(Bytecode &code, const Operand &as) const override;
+  virtual NodeLabel getLabel() const override;
+  virtual std::size_t getOperandCount() const override;
+  virtual Operand getOperand(std::size_t index) const override;
+  virtual void releaseOperands(std::vector<NodePtr<Expression>> &operands) override;
 };
 
 class BinaryArithmeticOperation : public Arithmetic {
 private:
-  std::unique_ptr<Arithmetic> m_left;
+  NodePtr<Arithmetic> m_left;
   ActionTokenData m_token;
-  std::unique_ptr<Arithmetic> m_right;
+  NodePtr<Arithmetic> m_right;
 
 public:
-  BinaryArithmeticOperation(std::unique_ptr<Expression> &&left, ActionTokenData &&token,
-                            std::unique_ptr<Expression> &&right);
-
-  virtual std::string toString(const bool braces) const override;
-  virtual double evalGetDouble(const SymbolTable &symbol_table) const override;
-  virtual var eval(const SymbolTable &symbol_table) const override;
+  BinaryArithmeticOperation(NodePtr<Arithmetic> &&left, ActionTokenData &&token,
+                            NodePtr<Arithmetic> &&right);
+
+  virtual void printPart(std::string &out, std::size_t part, const bool braces) const override;
+  virtual void compile(Bytecode &code, const Operand &as) const override;
+  virtual NodeLabel getLabel() const override;
+  virtual std::size_t getOperandCount() const override;
+  virtual Operand getOperand(std::size_t index) const override;
+  virtual void releaseOperands(std::vector<NodePtr<Expression>> &operands) override;
 };
 
 class UnaryArithmeticOperation : public Arithmetic {
 private:
-  std::unique_ptr<Arithmetic> m_input;
+  NodePtr<Arithmetic> m_input;
   ActionTokenData m_token;
 
 public:
-  UnaryArithmeticOperation(std::unique_ptr<Expression> &&input, ActionTokenData &&token);
-  virtual std::string toString(const bool braces) const override;
-  virtual double evalGetDouble(const SymbolTable &symbol_table) const override;
-  virtual var eval(const SymbolTable &symbol_table) const override;
+  UnaryArithmeticOperation(NodePtr<Arithmetic> &&input, ActionTokenData &&token);
+  virtual void printPart(std::string &out, std::size_t part, const bool braces) const override;
+  virtual void compile(Bytecode &code, const Operand &as) const override;
+  virtual NodeLabel getLabel() const override;
+  virtual std::size_t getOperandCount() const override;
+  virtual Operand getOperand(std::size_t index) const override;
+  virtual void releaseOperands(std::vector<NodePtr<Expression>> &operands) override;
 };
 
 class FunctionArithmetic : public Arithmetic {
 private:
-  std::unique_ptr<Arithmetic> m_input;
+  NodePtr<Arithmetic> m_input;
   ActionTokenData m_token;
 
 public:
-  FunctionArithmetic(std::unique_ptr<Expression> &&input, ActionTokenData &&token);
-  virtual std::string toString(const bool braces) const override;
-  virtual double evalGetDouble(const SymbolTable &symbol_table) const override;
-  virtual var eval(const SymbolTable &symbol_table) const override;
+  FunctionArithmetic(NodePtr<Arithmetic> &&input, ActionTokenData &&token);
+  virtual void printPart(std::string &out, std::size_t part, const bool braces) const override;
+  virtual void compile(Bytecode &code, const Operand &as) const override;
+  virtual NodeLabel getLabel() const override;
+  virtual std::size_t getOperandCount() const override;
+  virtual Operand getOperand(std::size_t index) const override;
+  virtual void releaseOperands(std::vector<NodePtr<Expression>> &operands) override;
 };
 
 class AtomicBoolean : public Boolean {
 private:
-  TokenData m_token;
+  bool m_value;
+  DebugIndex m_debug;
 
 public:
-  AtomicBoolean(TokenData &&token);
-  virtual std::string toString(const bool braces) const override;
-  virtual bool evalGetBool(const SymbolTable &symbol_table) const override;
-  virtual var eval(const SymbolTable &symbol_table) const override;
+  AtomicBoolean(bool value, DebugIndex debug = no_debug_info);
+  virtual void printPart(std::string &out, std::size_t part, const bool braces) const override;
+  virtual void compile(Bytecode &code, const Operand &as) const override;
+  virtual NodeLabel getLabel() const override;
 };
 
 class ParenthesesBoolean : public Boolean {
 private:
-  TokenData m_token;
-  std::unique_ptr<Boolean> m_input;
+  DebugIndex m_debug;
+  NodePtr<Boolean> m_input;
 
 public:
-  ParenthesesBoolean(std::unique_ptr<Expression> &&input, TokenData &&token);
-  virtual std::string toString(const bool braces) const override;
-  virtual bool evalGetBool(const SymbolTable &symbol_table) const override;
-  virtual var eval(const SymbolTable &symbol_table) const override;
+  ParenthesesBoolean(NodePtr<Boolean> &&input, DebugIndex debug = no_debug_info);
+  virtual void printPart(std::string &out, std::size_t part, const bool braces) const override;
+  virtual void compile(Bytecode &code, const Operand &as) const override;
+  virtual NodeLabel getLabel() const override;
+  virtual std::size_t getOperandCount() const override;
+  virtual Operand getOperand(std::size_t index) const override;
+  virtual void releaseOperands(std::vector<NodePtr<Expression>> &operands) override;
 };
 
 class BinaryBooleanOperation : public Boolean {
 private:
-  std::unique_ptr<Boolean> m_left;
+  NodePtr<Boolean> m_left;
   ActionTokenData m_token;
-  std::unique_ptr<Boolean> m_right;
+  NodePtr<Boolean> m_right;
 
 public:
-  BinaryBooleanOperation(std::unique_ptr<Expression> &&left, ActionTokenData &&token,
-                         std::unique_ptr<Expression> &&right);
-  virtual std::string toString(const bool braces) const override;
-  virtual bool evalGetBool(const SymbolTable &symbol_table) const override;
-  virtual var eval(const SymbolTable &symbol_table) const override;
+  BinaryBooleanOperation(NodePtr<Boolean> &&left, ActionTokenData &&token,
+                         NodePtr<Boolean> &&right);
+  virtual void printPart(std::string &out, std::size_t part, const bool braces) const override;
+  virtual void compile(Bytecode &code, const Operand &as) const override;
+  virtual NodeLabel getLabel() const override;
+  virtual std::size_t getOperandCount() const override;
+  virtual Operand getOperand(std::size_t index) const override;
+  virtual void releaseOperands(std::vector<NodePtr<Expression>> &operands) override;
 };
 
 class Comparision : public Boolean {
 private:
-  std::unique_ptr<Arithmetic> m_left;
+  NodePtr<Arithmetic> m_left;
   ActionTokenData m_token;
-  std::unique_ptr<Arithmetic> m_right;
+  NodePtr<Arithmetic> m_right;
 
 public:
-  Comparision(std::unique_ptr<Expression> &&left, ActionTokenData &&token,
-              std::unique_ptr<Expression> &&right);
-  virtual std::string toString(const bool braces) const override;
-  virtual bool evalGetBool(const SymbolTable &symbol_table) const override;
-  virtual var eval(const SymbolTable &symbol_table) const override;
+  Comparision(NodePtr<Arithmetic> &&left, ActionTokenData &&token,
+              NodePtr<Arithmetic> &&right);
+  virtual void printPart(std::string &out, std::size_t part, const bool braces) const override;
+  virtual void compile(Bytecode &code, const Operand &as) const override;
+  virtual NodeLabel getLabel() const override;
+  virtual std::size_t getOperandCount() const override;
+  virtual Operand getOperand(std::size_t index) const override;
+  virtual void releaseOperands(std::vector<NodePtr<Expression>> &operands) override;
 };
 
 class UnaryBooleanOperation : public Boolean {
 private:
-  std::unique_ptr<Boolean> m_input;
+  NodePtr<Boolean> m_input;
   ActionTokenData m_token;
 
 public:
-  UnaryBooleanOperation(std::unique_ptr<Expression> &&input, ActionTokenData &&token);
-  virtual std::string toString(const bool braces) const override;
-  virtual bool evalGetBool(const SymbolTable &symbol_table) const override;
-  virtual var eval(const SymbolTable &symbol_table) const override;
+  UnaryBooleanOperation(NodePtr<Boolean> &&input, ActionTokenData &&token);
+  virtual void printPart(std::string &out, std::size_t part, const bool braces) const override;
+  virtual void compile(Bytecode &code, const Operand &as) const override;
+  virtual NodeLabel getLabel() const override;
+  virtual std::size_t getOperandCount() const override;
+  virtual Operand getOperand(std::size_t index) const override;
+  virtual void releaseOperands(std::vector<NodePtr<Expression>> &operands) override;
 };
 
 class Print : public Statement {
 private:
-  std::unique_ptr<Expression> m_value;
+  NodePtr<Expression> m_value;
+  /*nested deeper than the recursion limit so destroyed with an explicit stack*/
+  bool m_deep;
 
 public:
-  Print(std::unique_ptr<Expression> &&value);
-  virtual std::string toString(const bool braces) const override;
-  virtual std::string evalGetString(SymbolTable &symbol_table) const override;
+  Print(NodePtr<Expression> &&value, bool deep = false);
+  virtual ~Print() override;
+  virtual void print(std::string &out, const bool braces) const override;
+  virtual void compile(Bytecode &code) const override;
 };
 
 class Assignment : public Statement {
 private:
-  TokenData m_token;
-  std::unique_ptr<Expression> m_value;
+  std::string_view m_name;
+  DebugIndex m_debug;
+  NodePtr<Expression> m_value;
   bool m_create_var;
+  /*nested deeper than the recursion limit so destroyed with an explicit stack*/
+  bool m_deep;
 
 public:
-  Assignment(std::unique_ptr<Expression> &&value, TokenData &&token, bool create_var);
-  virtual std::string toString(const bool braces) const override;
-  virtual std::string evalGetString(SymbolTable &symbol_table) const override;
+  Assignment(NodePtr<Expression> &&value, std::string_view name, bool create_var,
+             DebugIndex debug = no_debug_info, bool deep = false);
+  virtual ~Assignment() override;
+  virtual void print(std::string &out, const bool braces) const override;
+  virtual void compile(Bytecode &code) const override;
 };
 
 #endif
\ No newline at end of file
@@ -1,10 +1,12 @@
 #ifndef AST_TOKEN_HPP
 #define AST_TOKEN_HPP
 
+#include "DebugInfo.hpp"
 #include "tokens.hpp"
-#include <cstddef>
+#include <cstdint>
+#include <string_view>
 
-enum class ActionTokens {
+enum class ActionTokens : std::uint8_t {
   sin,
   cos,
   tan,
@@ -32,27 +34,28 @@ enum class ActionTokens {
   positive
 };
 
+/**
+ * @brief
+ * an operation in the AST and its entry in the debug info of its program
+ */
 class ActionTokenData {
 public:
   ActionTokens m_token;
 
 private:
-  std::size_t m_postion{0};
-  std::size_t m_line{0};
-  std::string m_text{""};
+  DebugIndex m_debug{no_debug_info};
 
 public:
-  ActionTokenData(TokenData &lexer_token, ActionTokens token);
-  ActionTokenData(ActionTokens token);
-  ActionTokenData(const ActionTokenData &token_data) = default;
-  ActionTokenData(ActionTokenData &&token_data) = default;
-  ActionTokenData &operator=(const ActionTokenData &token_data) = default;
+  ActionTokenData(ActionTokens token, DebugIndex debug = no_debug_info);
 
   ActionTokens getToken() const;
-  const std::string getLocation() const;
-  const std::string getText() const;
-  const std::string getOperation() const;
-  const std::string getOperator() const;
+  DebugIndex getDebugIndex() const;
+  /*human readable name of the operation*/
+  std::string_view getOperation() const;
+  /*the operator as written in the source*/
+  std::string_view getOperator() const;
+  /*the operands may be swapped without changing the result, as for + * and or equal_to*/
+  bool isCommutative() const;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,170 @@
+#ifndef BYTECODE_HPP
+#define BYTECODE_HPP
+
+#include "ActionTokens.hpp"
+#include "DebugInfo.hpp"
+#include "Errors.hpp"
+#include "Node.hpp"
+#include "Types.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/*
+what an instruction does, which of its members are used follows from it
+the values up to assign label the nodes of fingerprints so they must keep their order
+*/
+enum class Opcode : std::uint8_t {
+  /*push a literal*/
+  number,
+  boolean,
+  /*push a variable of either type*/
+  load,
+  /*replace the operands on top of the stack with the result of the action*/
+  binary_arithmetic,
+  unary_arithmetic,
+  function,
+  binary_boolean,
+  unary_boolean,
+  comparison,
+  /*end a statement taking the value on top of the stack*/
+  print,
+  assign,
+  /*push a variable checked to be the type its operation needs*/
+  load_number,
+  load_boolean,
+  /*end a statement declaring a variable*/
+  create,
+  /*fail an assignment to a built in constant before its value is evaluated*/
+  constant,
+  /*copy the value on top of the stack to a temporary, and push a copy of a temporary*/
+  keep,
+  reload,
+  /*replace the number on top of the stack with the result of an operation by a literal*/
+  power,
+  scale,
+  remainder,
+};
+
+/**
+ * @brief
+ * one step of the stack machine, 16 bytes so a cache line holds four
+ * the debug index is that of the operation or the assignment that may fail
+ */
+struct Instruction {
+  Opcode m_op;
+  ActionTokens m_action;
+  DebugIndex m_debug;
+  union {
+    double m_number;
+    bool m_boolean;
+    /*the slot of a variable or temporary*/
+    std::uint32_t m_slot;
+    std::uint32_t m_exponent;
+  };
+};
+
+static_assert(sizeof(Instruction) == 16);
+
+/**
+ * @brief
+ * a program lowered to instructions for a stack machine, each statement is the instructions of
+ * its value in postorder followed by the instruction printing or storing it
+ * run switches on each instruction in turn, there are no virtual calls and nothing recurses so
+ * a statement of any depth runs the same way
+ * results and errors are the same as evaluating the AST, the first error stops the run
+ * each variable is given a slot as it is compiled and is only looked up by name in the symbol
+ * table once per run
+ */
+class Bytecode {
+private:
+  /*the value of a variable while running and whether it exists or was stored to*/
+  struct Slot;
+
+  std::vector<Instruction> m_code{};
+  /*the name of each slot and the slot of each name*/
+  std::vector<std::string_view> m_names{};
+  std::unordered_map<std::string_view, std::uint32_t> m_slots{};
+  std::size_t m_statements{};
+  /*values on the stack after the last instruction and the most there ever are*/
+  std::size_t m_depth{};
+  std::size_t m_stack_size{};
+  /*values kept to be reloaded*/
+  std::size_t m_temporaries{};
+
+  void add(const Instruction &instruction, std::ptrdiff_t pushed);
+  std::uint32_t addSlot(std::string_view name);
+  /*run the instructions against slots, the variables found in the symbol table are defined*/
+  bool execute(Slot *slots, std::string &out, Fault &fault, std::size_t &statement) const;
+
+public:
+  Bytecode() = default;
+
+  /*
+  lower expression walking it with an explicit stack, its value is left on the stack
+  each node adds its own instruction once its operands have
+  */
+  void addExpression(const Expression &expression);
+  void addNumber(double value);
+  void addBoolean(bool value);
+  /*op is one of the loads, name must outlive this bytecode*/
+  void addVariable(Opcode op, std::string_view name, DebugIndex debug);
+  void addOperation(Opcode op, const ActionTokenData &token);
+  void addPrint();
+  void addStore(std::string_view name, bool create, DebugIndex debug);
+  void addConstant(DebugIndex debug);
+  /*the statements of other after those of this*/
+  void append(const Bytecode &other);
+  /**
+   * @brief
+   * replace operations on literals with their value and drop operations that leave their
+   * operand unchanged, such as x * 1, - - x and b and true
+   * results are the same bit for bit, an operation that fails is kept so it fails when run
+   * @return std::size_t the number of instructions removed
+   */
+  std::size_t fold();
+  /**
+   * @brief
+   * rewrite operations to cheaper ones giving the same results and errors, after fold and before
+   * reuse
+   * x ^ 0 becomes one and x ^ 1 x, division by a power of two multiplying by its reciprocal,
+   * modulo by a power of two exact arithmetic in place of fmod, and Int of a value that is
+   * already integral is dropped
+   * @return std::size_t the number of instructions removed
+   */
+  std::size_t reduce();
+  /**
+   * @brief
+   * evaluate each repeated subexpression once, keeping its value where it is first evaluated and
+   * reloading it where it is repeated, within a statement or in later ones until a variable it
+   * loads is stored to
+   * the instructions run in order without branching so the first evaluation always runs before
+   * the repeats, and stops the program if it fails
+   * run after fold, running it again keeps what an earlier run kept, the values it reloads count
+   * as repeats of the values kept
+   * @return std::size_t the number of instructions removed
+   */
+  std::size_t reuse();
+
+  /**
+   * @brief
+   * run every statement appending what they print to out
+   * the variables used are read from symbol_table before running and those stored written back
+   * after, including when a statement fails
+   * @param symbol_table
+   * @param out
+   * @param fault the first error
+   * @param statement the index of the statement that failed
+   * @return false once a statement fails, the statements before it have run
+   */
+  bool run(SymbolTable &symbol_table, std::string &out, Fault &fault,
+           std::size_t &statement) const;
+  /*the fingerprint Program::getFingerprint gives, in one pass over the instructions*/
+  Fingerprint getFingerprint(bool commutative, std::vector<Fingerprint> *subtrees) const;
+  std::size_t getMemoryUsage() const;
+};
+
+#endif
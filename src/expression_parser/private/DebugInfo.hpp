@@ -0,0 +1,56 @@
+#ifndef DEBUG_INFO_HPP
+#define DEBUG_INFO_HPP
+
+#include "tokens.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+/*a node's entry in the debug info of its program*/
+using DebugIndex = std::uint32_t;
+
+/*the entry of nodes that did not come from a source, its location is the default one*/
+const constexpr DebugIndex no_debug_info{0};
+
+/**
+ * @brief
+ * where the nodes of a program came from in the source and the text they were written as
+ * kept beside the AST so a node holds a 4 byte index instead of a location, and views text
+ * stored here instead of owning a copy of it
+ * an entry is only the offset its token ends at, the line and postion are worked out from the
+ * line starts of the source when an error is reported
+ */
+class DebugInfo {
+private:
+  std::vector<std::uint32_t> m_ends{0};
+  std::vector<std::uint32_t> m_line_starts{0};
+  SourceLocation m_origin{};
+  /*text is never moved once added so the views handed out live as long as this table*/
+  std::pmr::monotonic_buffer_resource m_text{};
+  std::size_t m_text_bytes{};
+
+public:
+  DebugInfo() = default;
+  DebugInfo(const DebugInfo &other) = delete;
+  DebugInfo &operator=(const DebugInfo &other) = delete;
+
+  /**
+   * @brief
+   * the source tokens added next were lexed from
+   * @param line_starts offset of the first character of each line
+   * @param origin where the source begins in the whole source
+   * @param tokens number of tokens so the entries are allocated once
+   */
+  void setSource(std::vector<std::uint32_t> line_starts, const SourceLocation &origin,
+                 std::size_t tokens);
+  DebugIndex addLocation(const TokenData &token);
+  std::string_view addText(std::string_view text);
+  SourceLocation getLocation(DebugIndex index) const;
+  std::size_t size() const;
+  /*bytes held by the entries and the text*/
+  std::size_t getMemoryUsage() const;
+};
+
+#endif
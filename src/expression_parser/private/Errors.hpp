@@ -1,36 +1,111 @@
 #ifndef ERRORS_EP_HPP
 #define ERRORS_EP_HPP
 
+#include "DebugInfo.hpp"
+#include "Result.hpp"
+#include "tokens.hpp"
 #include <exception>
 #include <string>
+#include <string_view>
+
+/*the first line of the message of an error with code*/
+std::string_view getHeading(ErrorCode code);
+
+/**
+ * @brief
+ * an error recorded instead of thrown so malformed input costs no unwinding
+ * nothing is formatted until the error is reported, raise throws the error that would have been
+ * thrown in its place
+ */
+struct Fault {
+  ErrorCode m_code{ErrorCode::none};
+  /*a literal, text that may not outlive the fault is kept in m_detail*/
+  std::string_view m_description{};
+  /*appended to the description, such as the operator of a type error*/
+  std::string m_detail{};
+  SourceLocation m_location{};
+  /*where to look the location up while it is not known*/
+  DebugIndex m_debug{no_debug_info};
+  bool m_located{true};
+
+  Fault() = default;
+  Fault(ErrorCode code, std::string_view description, const SourceLocation &location,
+        std::string detail = {});
+  /*recorded by a node, located later by whoever owns the debug info of the node*/
+  Fault(ErrorCode code, std::string_view description, DebugIndex debug);
+
+  /*true once an error is recorded*/
+  explicit operator bool() const;
+  /*record an error unless an earlier one is, what is evaluated after an error is meaningless*/
+  void record(ErrorCode code, std::string_view description, DebugIndex debug);
+  /*find the location in the debug info the node was made with, nothing if already known*/
+  void locate(const DebugInfo &debug_info);
+  std::string getDescription() const;
+  /*the error once located*/
+  EvalError getError() const;
+  [[noreturn]] void raise() const;
+};
 
 class LexicalError : public std::exception {
 private:
   std::string m_message{"Lexing Error\n"};
+  std::string m_description;
+  SourceLocation m_location;
 
 public:
-  LexicalError(std::string message, std::string location);
+  LexicalError(std::string_view message, const SourceLocation &location);
 
   virtual const char *what() const noexcept;
+  std::string_view getDescription() const;
+  const SourceLocation &getLocation() const;
+  Fault getFault() const;
 };
 
 class SyntaxError : public std::exception {
 private:
   std::string m_message{"Syntax Error Occurred\n"};
+  std::string m_description;
+  SourceLocation m_location;
+  /*where to look the location up while it is not known*/
+  DebugIndex m_debug{no_debug_info};
+  bool m_located{true};
+  ErrorCode m_code;
 
 public:
-  SyntaxError(std::string message, std::string location);
+  SyntaxError(ErrorCode code, std::string_view message, const SourceLocation &location);
+  /*thrown by a node, located later by whoever owns the debug info of the node*/
+  SyntaxError(ErrorCode code, std::string_view message, DebugIndex debug);
 
   virtual const char *what() const noexcept;
+  std::string_view getDescription() const;
+  const SourceLocation &getLocation() const;
+  ErrorCode getCode() const;
+  Fault getFault() const;
+  /*find the location in the debug info the node was made with, nothing if already known*/
+  void locate(const DebugInfo &debug_info);
 };
 
 class RuntimeError : public std::exception {
 private:
   std::string m_message{"Runtime Error\n"};
+  std::string m_description;
+  SourceLocation m_location;
+  /*where to look the location up while it is not known*/
+  DebugIndex m_debug{no_debug_info};
+  bool m_located{true};
+  ErrorCode m_code;
 
 public:
-  RuntimeError(std::string message, std::string location);
+  RuntimeError(ErrorCode code, std::string_view message, const SourceLocation &location);
+  /*thrown by a node, located later by whoever owns the debug info of the node*/
+  RuntimeError(ErrorCode code, std::string_view message, DebugIndex debug);
   virtual const char *what() const noexcept;
+  std::string_view getDescription() const;
+  const SourceLocation &getLocation() const;
+  ErrorCode getCode() const;
+  Fault getFault() const;
+  /*find the location in the debug info the node was made with, nothing if already known*/
+  void locate(const DebugInfo &debug_info);
 };
 
-#endif
\ No newline at end of file
+#endif
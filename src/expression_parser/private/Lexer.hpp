@@ -1,38 +1,58 @@
 #ifndef LEXER_HPP
 #define LEXER_HPP
 
+#include "Scanner.hpp"
+#include "TokenBuffer.hpp"
 #include "tokens.hpp"
 #include <cstddef>
-#include <sstream>
-#include <stack>
-#include <string>
-
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief
+ * scans a contiguous block of source text in place
+ * tokens refer to the source by offset so it must outlive the lexer and its tokens
+ * the source may be a piece of a larger one starting at origin, locations are then reported
+ * from the start of the whole source
+ */
 class Lexer {
 private:
-  std::istringstream m_iss;
-  std::string m_buffer;
-  std::size_t m_postion{};
-  std::size_t m_line{};
+  std::string_view m_source;
+  SourceLocation m_origin;
+  const Scanner &m_scanner;
+  std::size_t m_offset{};
+  std::uint32_t m_line{};
+  /*offset of the first character of each line*/
+  std::vector<std::uint32_t> m_line_starts{0};
   TokenData m_cur_token;
-  std::stack<TokenData> m_tokenBuffer{};
 
 public:
-  explicit Lexer(std::istringstream &&ss);
+  explicit Lexer(std::string_view source, SourceLocation origin = {},
+                 const Scanner &scanner = getScanner());
   Lexer(const Lexer &) = delete;
   Lexer &operator=(const Lexer &) = delete;
   Lexer(Lexer &&) = delete;
   Lexer &operator=(Lexer &&) = delete;
 
-  const TokenData getCurrentToken() const;
+  const TokenData &getCurrentToken() const;
+
+  /*the source text of a token*/
+  std::string_view getText(const TokenData &token) const;
+
+  /*the line and postion of the last character of a token*/
+  SourceLocation getLocation(const TokenData &token) const;
 
   /*move to the next token*/
   void advance();
 
-  void pushBackToken(TokenData token);
+  /*lex every remaining token in one pass, the lexer is spent afterwards
+  a lexical error ends the buffer instead of being thrown*/
+  TokenBuffer tokenize();
 
 private:
-  /*get the next token in the stream*/
+  /*get the next token in the source*/
   const TokenData getToken();
 };
 
-#endif
\ No newline at end of file
+#endif
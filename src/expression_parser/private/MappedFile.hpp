@@ -0,0 +1,34 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#if __has_include(<sys/mman.h>)
+#define MAPPED_FILE_MMAP
+#endif
+
+/**
+ * @brief
+ * a whole file mapped read only into memory, pages are read in by the OS as they are touched
+ * isMapped is false where memory mapping is unsupported so callers can read the file instead
+ */
+class MappedFile {
+private:
+  const char *m_data{nullptr};
+  std::size_t m_size{};
+  bool m_mapped{false};
+
+public:
+  /*throws std::system_error if the file cannot be opened*/
+  explicit MappedFile(const std::string &path);
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  ~MappedFile();
+
+  bool isMapped() const;
+  std::string_view getText() const;
+};
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef OPERATIONS_HPP
+#define OPERATIONS_HPP
+
+#include "ActionTokens.hpp"
+#include "Errors.hpp"
+#include "Node.hpp"
+#include "Types.hpp"
+#include <cstdint>
+#include <string>
+
+/*
+the operations of the AST, shared by the bytecode and folding
+errors are recorded in fault at the debug index of the operation, the result is then meaningless
+*/
+double applyBinary(const ActionTokenData &token, double left, double right, Fault &fault);
+double applyFunction(const ActionTokenData &token, double input, Fault &fault);
+double applyUnary(const ActionTokenData &token, double input);
+/*
+the operations by a literal Bytecode::reduce rewrites to, cheaper than applyBinary with the literal
+with the same results and errors
+*/
+/*exponent is zero or one*/
+double applyPower(const ActionTokenData &token, double base, std::uint32_t exponent, Fault &fault);
+/*divide by the power of two whose reciprocal is given*/
+double applyScale(const ActionTokenData &token, double dividend, double reciprocal, Fault &fault);
+/*modulo by a power of two of at least one*/
+double applyRemainder(const ActionTokenData &token, double dividend, double divisor, Fault &fault);
+bool applyBoolean(const ActionTokenData &token, bool left, bool right);
+bool applyComparison(const ActionTokenData &token, double left, double right);
+
+/*append the line a print statement writes for value*/
+void appendValue(std::string &out, const var &value);
+
+/*destroy an expression one node at a time with an explicit stack, arena nodes need no walk*/
+void destroyIteratively(NodePtr<Expression> &&expression);
+
+#endif
@@ -1,29 +1,201 @@
 #ifndef PARSER_HPP
 #define PARSER_HPP
 
-#include "Lexer.hpp"
+#include "ActionTokens.hpp"
+#include "Errors.hpp"
 #include "Node.hpp"
+#include "TokenBuffer.hpp"
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief
+ * how tightly an operator holds its operands, each binds tighter than the one before
+ * and and or share a precedence and are left associative as are + - and * / %
+ * comparisons and ^ do not chain, 2 ^ 3 ^ 2 is an error
+ * not applies to a whole comparison and only starts an operand of and or
+ * unary + and - apply to a primary, the operand of a function or a literal, variable or bracket
+ */
+enum class Precedence : std::uint8_t {
+  none,
+  boolean,
+  negation,
+  comparison,
+  additive,
+  multiplicative,
+  power,
+  unary,
+  primary,
+};
 
 class Parser {
 public:
-  Parser() = default;
+  /**
+   * @brief
+   * nodes are kept where allocation says, an arena frees the whole tree at once
+   * statements nested deeper than recursion_limit are destroyed without recursing, parsing and
+   * evaluation never recurse
+   * @param allocation
+   * @param recursion_limit
+   */
+  explicit Parser(NodeAllocation allocation = NodeAllocation::heap,
+                  std::uint32_t recursion_limit = default_recursion_limit);
+
+  std::unique_ptr<Program> genAST(std::string_view s);
+  std::unique_ptr<Program> genAST(TokenBuffer &&tokens);
+  /*
+  as above without throwing, null with the error genAST would throw in fault
+  the first error stops parsing so nothing is unwound
+  */
+  std::unique_ptr<Program> genAST(std::string_view s, Fault &fault);
+  std::unique_ptr<Program> genAST(TokenBuffer &&tokens, Fault &fault);
 
-  std::unique_ptr<Program> genAST(std::string &s);
+  /**
+   * @brief
+   * parse a large source on several threads
+   * the source is split after top level semicolons, every ; ends a statement, and the pieces are
+   * lexed and parsed independently then joined in source order
+   * the result and the error thrown are the same as genAST, the first error in source order
+   * @param s
+   * @param threads 1 or less parses on the calling thread
+   * @param allocation
+   * @param recursion_limit
+   * @return std::unique_ptr<Program>
+   */
+  static std::unique_ptr<Program>
+  genASTParallel(std::string_view s, std::size_t threads,
+                 NodeAllocation allocation = NodeAllocation::heap,
+                 std::uint32_t recursion_limit = default_recursion_limit);
+
+  /**
+   * @brief
+   * check syntax and static types without building the AST
+   * throws the first error genAST would throw for the same source
+   * @param s
+   */
+  void validate(std::string_view s);
+  void validate(TokenBuffer &&tokens);
 
 private:
-  std::unique_ptr<Lexer> m_lexer;
-
-  std::unique_ptr<Statement> assignExpr();
-  std::unique_ptr<Expression> booleanUnaryExpr();
-  std::unique_ptr<Expression> booleanExpr();
-  std::unique_ptr<Expression> comparisonExpr();
-  std::unique_ptr<Expression> addExpr();
-  std::unique_ptr<Expression> mulExpr();
-  std::unique_ptr<Expression> powExpr();
-  std::unique_ptr<Expression> unaryExpr();
-  std::unique_ptr<Expression> primary();
-  std::unique_ptr<Expression> getArgument();
+  /*the type of an expression known while parsing, a variable's is only known once evaluated*/
+  enum class StaticType : std::uint8_t { double_, bool_, unknown };
+
+  /**
+   * @brief
+   * an expression and its static type, the node is null when only validating
+   * m_arithmetic and m_boolean view m_node as the operand types it was built as so the nodes it
+   * becomes an operand of take it without a downcast, a variable is both and has an Expression
+   * in each so m_node is the one of its Arithmetic
+   * one dropped on an error is destroyed without recursing when it is deep
+   */
+  struct Parsed {
+    NodePtr<Expression> m_node{};
+    StaticType m_type{StaticType::unknown};
+    /*the nodes on the longest path from m_node to a leaf, and the depth of the parser above which
+    a node is destroyed with an explicit stack*/
+    std::uint32_t m_depth{};
+    std::uint32_t m_recursion_limit{default_recursion_limit};
+    Arithmetic *m_arithmetic{nullptr};
+    Boolean *m_boolean{nullptr};
+
+    Parsed() = default;
+    explicit Parsed(StaticType type);
+    template <typename T>
+    Parsed(NodePtr<T> &&node, StaticType type, std::uint32_t recursion_limit,
+           std::uint32_t depth = 1);
+    Parsed(Parsed &&other) = default;
+    Parsed &operator=(Parsed &&other) = default;
+    ~Parsed();
+
+    bool isArithmetic() const;
+    bool isBoolean() const;
+    /*move the node out as an operand, the static type must allow it*/
+    NodePtr<Arithmetic> takeArithmetic();
+    NodePtr<Boolean> takeBoolean();
+  };
+
+  /*what is built once the operand an operator or bracket is waiting for is complete*/
+  enum class Continuation : std::uint8_t { infix, unary, negation, parentheses, function };
+
+  /*an operator or bracket waiting for its operand*/
+  struct Pending {
+    Continuation m_continuation;
+    TokenData m_token;
+    ActionTokens m_action;
+    /*an infix operator's, its operand holds only operators binding tighter*/
+    Precedence m_precedence;
+    /*the precedence of the expression the operator is in, restored once it is complete*/
+    Precedence m_min;
+    /*the left operand of an infix operator*/
+    Parsed m_left;
+  };
+
+  NodeAllocation m_allocation;
+  std::uint32_t m_recursion_limit;
+  /*makes the nodes of the program being built*/
+  NodeAllocator m_nodes{};
+  TokenBuffer m_tokens;
+  std::size_t m_index{};
+  /*false when only validating*/
+  bool m_build{true};
+  /*kept in place of the call stack so nesting is limited by memory*/
+  std::vector<Pending> m_pending{};
+  /*the first error found, every parsing function returns as soon as it holds one*/
+  Fault m_fault{};
+
+  /*output is null when only validating*/
+  void parseProgram(Program *output);
+  NodePtr<Statement> assignExpr();
+
+  /**
+   * @brief
+   * parse an expression whose operators all bind at least as tightly as min
+   * operators are looked up in a table so an operand costs one iteration whatever its depth in
+   * the grammar, operators and brackets waiting for an operand are kept on m_pending
+   * @param min
+   * @return Parsed
+   */
+  Parsed parseExpression(Precedence min);
+  /*a literal or variable*/
+  Parsed primary();
+
+  TokenData getCurrentToken() const;
+
+  /*the kind of a token ahead of the current one, recording a lexical error found there*/
+  Token peek(std::size_t ahead);
+
+  /*move to the next token, false with the lexical error found there recorded*/
+  bool advance();
+  /*record an error at a token*/
+  void fail(ErrorCode code, std::string_view description, const TokenData &token,
+            std::string detail = {});
+
+  /*record where a token is in the debug info of the program being built*/
+  DebugIndex addLocation(const TokenData &token) const;
+  /*copy the text of a token into the debug info of the program being built*/
+  std::string_view addText(const TokenData &token) const;
+  /*an AST operation located at a token*/
+  ActionTokenData makeAction(const TokenData &token, ActionTokens action) const;
+
+  /*
+  check the static types of the operands then build the node unless only validating
+  errors are recorded in m_fault
+  */
+  NodePtr<Statement> makeAssignment(Parsed &&value, const TokenData &name, bool create_var) const;
+  NodePtr<Statement> makePrint(Parsed &&value) const;
+  Parsed makeBinaryArithmetic(Parsed &&left, const TokenData &token, ActionTokens action,
+                              Parsed &&right);
+  Parsed makeUnaryArithmetic(const TokenData &token, ActionTokens action, Parsed &&input);
+  Parsed makeFunction(const TokenData &token, ActionTokens action, Parsed &&input);
+  Parsed makeBinaryBoolean(Parsed &&left, const TokenData &token, ActionTokens action,
+                           Parsed &&right);
+  Parsed makeUnaryBoolean(const TokenData &token, ActionTokens action, Parsed &&input);
+  Parsed makeComparison(Parsed &&left, const TokenData &token, ActionTokens action,
+                        Parsed &&right);
 };
 
 #endif
\ No newline at end of file
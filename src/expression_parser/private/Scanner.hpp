@@ -0,0 +1,74 @@
+#ifndef SCANNER_HPP
+#define SCANNER_HPP
+
+#include <array>
+#include <cstdint>
+
+/**
+ * @brief
+ * ascii character classes used by the lexer, independent of the current locale
+ */
+enum CharClass : std::uint8_t {
+  char_space = 1 << 0,
+  char_digit = 1 << 1,
+  char_alpha = 1 << 2,
+  char_identifier = 1 << 3,
+};
+
+namespace scanner_detail {
+constexpr std::array<std::uint8_t, 256> makeCharClasses() {
+  std::array<std::uint8_t, 256> classes{};
+  for (int c = 0; c < 256; ++c) {
+    std::uint8_t out{};
+    if (c == ' ' || (c >= '\t' && c <= '\r')) {
+      out |= char_space;
+    }
+    if (c >= '0' && c <= '9') {
+      out |= char_digit | char_identifier;
+    }
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+      out |= char_alpha | char_identifier;
+    }
+    if (c == '_') {
+      out |= char_identifier;
+    }
+    classes[static_cast<std::size_t>(c)] = out;
+  }
+  return classes;
+}
+} // namespace scanner_detail
+
+inline constexpr std::array<std::uint8_t, 256> char_classes{scanner_detail::makeCharClasses()};
+
+constexpr bool hasCharClass(char c, CharClass char_class) {
+  return (char_classes[static_cast<unsigned char>(c)] & char_class) != 0;
+}
+
+/**
+ * @brief
+ * finds the end of runs of characters belonging to one class
+ * each function returns a pointer to the first character in [first, last) outside the class
+ * or last if there is none
+ */
+struct Scanner {
+  const char *(*m_skip_whitespace)(const char *first, const char *last);
+  const char *(*m_skip_digits)(const char *first, const char *last);
+  const char *(*m_skip_identifier)(const char *first, const char *last);
+  const char *m_name;
+};
+
+/**
+ * @brief
+ * the fastest scanner supported by the cpu, chosen once at runtime
+ * @return const Scanner&
+ */
+const Scanner &getScanner();
+
+/**
+ * @brief
+ * byte at a time scanner, always available
+ * @return const Scanner&
+ */
+const Scanner &getScalarScanner();
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef STATEMENT_STREAM_HPP
+#define STATEMENT_STREAM_HPP
+
+#include "tokens.hpp"
+#include <string>
+#include <string_view>
+
+/**
+ * @brief
+ * splits source fed in chunks into complete statements so they can run as soon as they end
+ * every ; is a token of its own and ends a statement, so a token straddling a chunk boundary
+ * is carried over whole with the rest of its statement
+ * only the unfinished statement is ever copied, statements within a chunk are views into it
+ */
+class StatementStream {
+private:
+  std::string_view m_chunk{};
+  /*start of an unfinished statement from earlier chunks*/
+  std::string m_carry{};
+  /*a statement completed from the carry, kept alive until the next call*/
+  std::string m_statement{};
+  /*where the next statement starts in the whole source*/
+  SourceLocation m_origin{};
+
+public:
+  /*the chunk must stay valid until next returns false*/
+  void feed(std::string_view chunk);
+
+  /**
+   * @brief
+   * take the next complete statement, it stays valid until the next call
+   * @param statement the statement text up to and including its ;
+   * @param origin where the statement starts in the whole source
+   * @return false once the chunk holds no more complete statements
+   */
+  bool next(std::string_view &statement, SourceLocation &origin);
+
+  /*the text after the last statement once the last chunk is fed and next has returned false*/
+  std::string_view rest(SourceLocation &origin) const;
+
+private:
+  void advanceOrigin(std::string_view text);
+};
+
+#endif
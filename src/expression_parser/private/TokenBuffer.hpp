@@ -0,0 +1,56 @@
+#ifndef TOKEN_BUFFER_HPP
+#define TOKEN_BUFFER_HPP
+
+#include "Errors.hpp"
+#include "tokens.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief
+ * every token of a source held in parallel arrays
+ * tokens are addressed by index so lookahead and backtracking are index arithmetic
+ * ends with Token::EOF_sym unless lexing failed, the error is then kept for the parser to
+ * raise once it reaches that point so earlier syntax errors are still reported first
+ * the source must outlive the buffer
+ */
+class TokenBuffer {
+private:
+  std::string_view m_source{};
+  SourceLocation m_origin{};
+  std::vector<Token> m_tokens{};
+  std::vector<std::uint32_t> m_offsets{};
+  std::vector<std::uint32_t> m_lengths{};
+  std::vector<std::uint32_t> m_lines{};
+  /*offset of the first character of each line*/
+  std::vector<std::uint32_t> m_line_starts{};
+  std::optional<LexicalError> m_error{};
+
+public:
+  TokenBuffer() = default;
+  explicit TokenBuffer(std::string_view source, SourceLocation origin = {});
+
+  void reserve(std::size_t tokens);
+  void push(const TokenData &token);
+  void setLineStarts(std::vector<std::uint32_t> &&line_starts);
+  void setError(const LexicalError &error);
+
+  std::size_t size() const;
+  std::string_view getSource() const;
+  const SourceLocation &getOrigin() const;
+  const std::vector<std::uint32_t> &getLineStarts() const;
+  Token getToken(std::size_t index) const;
+  TokenData getTokenData(std::size_t index) const;
+  const std::optional<LexicalError> &getError() const;
+
+  /*the source text of a token*/
+  std::string_view getText(const TokenData &token) const;
+
+  /*the line and postion of the last character of a token*/
+  SourceLocation getLocation(const TokenData &token) const;
+};
+
+#endif
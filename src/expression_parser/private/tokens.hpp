@@ -2,13 +2,17 @@
 #define TOKENS_HPP
 
 #include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
 
 /**
  * @brief
  * Holds tokens for tokenizer and AST
  */
-enum class Token {
+enum class Token : std::int8_t {
   Id,
   Number,
   Sin,
@@ -45,29 +49,49 @@ enum class Token {
 
 /**
  * @brief
- * holds token and other information associated with the token
+ * line and postion of a token in the source
+ * only formatted into text when an error is reported
+ * as the origin of a piece of a larger source the postion counts the characters before it on
+ * its first line
+ */
+struct SourceLocation {
+  std::uint32_t m_line{};
+  std::uint32_t m_postion{};
+
+  std::string toString() const;
+};
+
+/**
+ * @brief
+ * a token and the span of source text it was lexed from
+ * trivially copyable, the text is recovered from the source it was lexed from
  */
 class TokenData {
 public:
   Token m_token;
 
 private:
-  std::size_t m_postion;
-  std::size_t m_line;
-  std::string m_text;
+  std::uint32_t m_offset;
+  std::uint32_t m_length;
+  std::uint32_t m_line;
 
 public:
-  TokenData(Token token, std::size_t postion = 0, std::size_t line = 0, std::string text = "");
-  TokenData(const TokenData &token_data) = default;
-  TokenData(TokenData &&token_data) = default;
-
-  TokenData &operator=(const TokenData &token_data) = default;
+  constexpr TokenData(Token token = Token::EOF_sym, std::uint32_t offset = 0,
+                      std::uint32_t length = 0, std::uint32_t line = 0)
+      : m_token(token), m_offset(offset), m_length(length), m_line(line) {}
 
   Token getToken() const;
-  const std::string getLocation() const;
-  const std::string getText() const;
-  std::size_t getPostion();
-  std::size_t getLine();
+  std::uint32_t getOffset() const;
+  std::uint32_t getLength() const;
+  std::uint32_t getLine() const;
+  std::string_view getText(std::string_view source) const;
+  /*the line and postion of the last character of the token, measured from the start of the
+  whole source when the lexed text begins at origin*/
+  SourceLocation getLocation(const std::vector<std::uint32_t> &line_starts,
+                             const SourceLocation &origin = {}) const;
 };
 
-#endif
\ No newline at end of file
+static_assert(std::is_trivially_copyable_v<TokenData>);
+static_assert(sizeof(TokenData) == 16);
+
+#endif
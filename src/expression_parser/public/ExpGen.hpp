@@ -14,14 +14,19 @@ private:
   std::unordered_map<std::string, DataTypes> m_symbol_table{};
   std::vector<std::string> m_bools{};
   std::vector<std::string> m_doubles{};
+  NodeAllocation m_allocation;
+  /*makes the nodes of the program being generated*/
+  NodeAllocator m_nodes{};
   struct Data;
   std::unique_ptr<Data> m_data;
 
 public:
-  ExpGen();
+  /*generated programs keep their nodes where allocation says*/
+  explicit ExpGen(NodeAllocation allocation = NodeAllocation::heap);
   ~ExpGen();
-  std::unique_ptr<Arithmetic> genArithmetic(const double prob = 1, bool unary = true);
-  std::unique_ptr<Boolean> genBoolean(const double prob = 1, bool unary = true);
+  /*nodes made outside a program keep their text in this generator so must not outlive it*/
+  NodePtr<Arithmetic> genArithmetic(const double prob = 1, bool unary = true);
+  NodePtr<Boolean> genBoolean(const double prob = 1, bool unary = true);
   std::unique_ptr<Program> getStatements(std::size_t count = 10);
 
 private:
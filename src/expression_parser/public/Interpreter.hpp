@@ -1,16 +1,89 @@
 #ifndef INTERPRETER_HPP
 #define INTERPRETER_HPP
 
+#include "Node.hpp"
+#include "ProgramCache.hpp"
+#include "Result.hpp"
 #include "Types.hpp"
+#include "Worksheet.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
 #include <string>
+#include <string_view>
 
 class Interpreter {
 private:
   SymbolTable m_symbol_table{};
+  std::uint32_t m_recursion_limit{default_recursion_limit};
+  ProgramCache *m_cache{&ProgramCache::getGlobal()};
 
 public:
   Interpreter();
-  [[nodiscard]] std::string evaluate(std::string &s);
+  [[nodiscard]] std::string evaluate(std::string_view s);
+  /**
+   * @brief
+   * evaluate without throwing, the error evaluate would throw is returned instead and its message
+   * is only formatted when asked for, statements before the error have still run
+   * @param s
+   * @return EvalResult
+   */
+  [[nodiscard]] EvalResult tryEvaluate(std::string_view s);
+  /*parse a large source on up to threads threads then run it, errors match evaluate*/
+  [[nodiscard]] std::string evaluate(std::string_view s, std::size_t threads);
+  /*run a worksheet reusing the statements it has already parsed*/
+  [[nodiscard]] std::string evaluate(const Worksheet &worksheet);
+  /**
+   * @brief
+   * check the syntax and static types of a source without running it or building its AST
+   * throws the same error evaluate would before running anything
+   * @param s
+   */
+  void validate(std::string_view s) const;
+  /**
+   * @brief
+   * the fingerprint of the program parsed from a source without running it, sources differing
+   * only in whitespace and redundant parentheses match, see Expression::getFingerprint
+   * throws the same error evaluate would before running anything
+   * @param s
+   * @param commutative
+   * @return Fingerprint
+   */
+  [[nodiscard]] Fingerprint getFingerprint(std::string_view s, bool commutative = false) const;
+  /**
+   * @brief
+   * run a script file statement by statement, writing each result as it completes
+   * the file is memory mapped where supported otherwise it is streamed
+   * stops at the first error which is thrown
+   * @param path
+   * @param out
+   */
+  void runFile(const std::string &path, std::ostream &out);
+  /**
+   * @brief
+   * run a script read in chunks from a stream such as a pipe statement by statement
+   * only the statement being read is held in memory
+   * stops at the first error which is thrown
+   * @param in
+   * @param out
+   * @param chunk_size bytes read at a time
+   */
+  void runStream(std::istream &in, std::ostream &out, std::size_t chunk_size = 1 << 16);
+  /**
+   * @brief
+   * statements nested deeper than limit are freed with an explicit stack instead of recursion,
+   * parsing and evaluation never recurse however deep the source nests
+   * @param limit
+   */
+  void setRecursionLimit(std::uint32_t limit);
+  /**
+   * @brief
+   * where evaluate and tryEvaluate look up sources already parsed, the global cache by default
+   * null parses every source again
+   * @param cache
+   */
+  void setProgramCache(ProgramCache *cache);
   const SymbolTable &getSymbolTable() const;
   void reset();
 };
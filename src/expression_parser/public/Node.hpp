@@ -2,17 +2,141 @@
 #define NODE_HPP
 
 #include "Types.hpp"
+#include <compare>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <memory_resource>
+#include <new>
+#include <ostream>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
+/**
+ * @brief
+ * deletes a node unless it lives in an arena
+ * arena nodes are released all at once with their arena without running their destructors
+ */
+struct NodeDeleter {
+  bool m_in_arena{false};
+
+  template <typename T> void operator()(T *node) const {
+    if (!m_in_arena) {
+      delete node;
+    }
+  }
+};
+
+template <typename T> using NodePtr = std::unique_ptr<T, NodeDeleter>;
+
+/*where the nodes of a program are allocated*/
+enum class NodeAllocation {
+  heap,
+  arena,
+};
+
+class DebugInfo;
+
+/**
+ * @brief
+ * makes nodes on the heap or in an arena
+ * nodes keep their locations and text in getDebugInfo so they own nothing outside themselves
+ */
+class NodeAllocator {
+private:
+  std::pmr::memory_resource *m_arena{nullptr};
+  DebugInfo *m_debug_info{nullptr};
+
+public:
+  NodeAllocator() = default;
+  NodeAllocator(std::pmr::memory_resource *arena, DebugInfo *debug_info);
+
+  DebugInfo &getDebugInfo() const;
+
+  template <typename T, typename... Args> NodePtr<T> make(Args &&...args) const {
+    if (!m_arena) {
+      return NodePtr<T>{new T(std::forward<Args>(args)...), NodeDeleter{false}};
+    }
+    void *memory{m_arena->allocate(sizeof(T), alignof(T))};
+    return NodePtr<T>{new (memory) T(std::forward<Args>(args)...), NodeDeleter{true}};
+  }
+};
+
+/**
+ * @brief
+ * expressions nested deeper than this are destroyed with an explicit stack, shallower ones
+ * recurse which is faster, every expression is compiled and run without recursing
+ */
+const constexpr std::uint32_t default_recursion_limit{4096};
+
+class Arithmetic;
+class Boolean;
+class Bytecode;
+struct Fault;
+
+/*an operand of an expression viewed as the type the expression evaluates it as*/
+struct Operand {
+  const Arithmetic *m_arithmetic{nullptr};
+  const Boolean *m_boolean{nullptr};
+};
+
+/**
+ * @brief
+ * a 128 bit hash of the structure of a tree, equal for trees that differ only in whitespace,
+ * redundant parentheses or how their literals are written
+ * the same on every platform and run so it may be stored or sent
+ */
+struct Fingerprint {
+  std::uint64_t m_high{};
+  std::uint64_t m_low{};
+
+  /*this fingerprint followed by word*/
+  Fingerprint mix(std::uint64_t word) const;
+  Fingerprint mix(const Fingerprint &other) const;
+  /*a hash of text as one word for mix*/
+  static std::uint64_t hashText(std::string_view text);
+  auto operator<=>(const Fingerprint &other) const = default;
+};
+
+/*what a node adds to a fingerprint besides its operands*/
+struct NodeLabel {
+  std::uint64_t m_kind{};
+  /*the value, name or operator that sets the node apart from others of its kind*/
+  std::uint64_t m_value{};
+  /*the operands may be swapped without changing the value*/
+  bool m_commutative{false};
+  /*only groups its operand so adds nothing*/
+  bool m_transparent{false};
+};
+
+/*how much of a program is optimized, each level does what the levels before it do*/
+enum class Optimization {
+  none,
+  /*operations on literals and identities are folded away*/
+  fold,
+  /*operations are rewritten to cheaper ones with the same results*/
+  reduce,
+  /*repeated subexpressions are evaluated once*/
+  reuse,
+};
+
 class Node {
 private:
 public:
   Node() = default;
   Node(const Node &other) = delete;
   Node &operator=(const Node &t) = delete;
-  virtual std::string toString(const bool braces) const = 0;
+  /*the source text of the node, see print*/
+  std::string toString(const bool braces) const;
+  /**
+   * @brief
+   * append the source text of the node to out in one pass without building the text of its parts
+   * @param out
+   * @param braces wrap every operation in parentheses
+   */
+  virtual void print(std::string &out, const bool braces) const = 0;
   virtual ~Node() = default;
 };
 
@@ -22,37 +146,53 @@ public:
   Expression(const Expression &other) = delete;
   Expression &operator=(const Expression &t) = delete;
   /**
-   * @brief calls evalGetDouble or evalGetBool as required
+   * @brief add the instruction of this expression alone to code, Bytecode::addExpression has
+   * added those of its operands
    *
-   * @param symbol_table
-   * @return var
+   * @param code
+   * @param as how the parent uses the value, empty for the root
    */
-  virtual var eval(const SymbolTable &symbol_table) const = 0;
+  virtual void compile(Bytecode &code, const Operand &as) const = 0;
+  virtual NodeLabel getLabel() const = 0;
+  /*printed with an explicit stack so a deep expression is printed as fast as a shallow one*/
+  virtual void print(std::string &out, const bool braces) const override;
   /**
-   * @brief Get the data type of the expression node
-   *
-   * @param symbol_table
-   * @return DataTypes
+   * @brief
+   * the fingerprint of this expression taken in one pass with an explicit stack
+   * @param commutative hash the operands of + * and or equal_to in a canonical order so a + b
+   * matches b + a
+   * @param subtrees if not null the fingerprint of every subtree is appended to it, operands
+   * before the expressions using them, to find repeated subtrees
+   * @return Fingerprint
    */
-  virtual DataTypes getDataType(const SymbolTable &symbol_table) const = 0;
+  Fingerprint getFingerprint(bool commutative = false,
+                             std::vector<Fingerprint> *subtrees = nullptr) const;
+
+  /*
+  the stack safe walks use these in place of recursion
+  an expression lists its operands, a leaf has none
+  */
+  virtual std::size_t getOperandCount() const;
+  virtual Operand getOperand(std::size_t index) const;
+  /*move the operands out so this expression is destroyed without destroying them*/
+  virtual void releaseOperands(std::vector<NodePtr<Expression>> &operands);
+  /*append the text before the operand part, the part after the last operand is the operand count*/
+  virtual void printPart(std::string &out, std::size_t part, const bool braces) const = 0;
 };
 
-class Arithmetic : virtual public Expression {
+/*expressions typed by what they evaluate to, they are run only once compiled to bytecode*/
+class Arithmetic : public Expression {
 public:
   Arithmetic() = default;
   Arithmetic(const Arithmetic &other) = delete;
   Arithmetic &operator=(const Arithmetic &t) = delete;
-  virtual double evalGetDouble(const SymbolTable &symbol_table) const = 0;
-  virtual DataTypes getDataType(const SymbolTable &symbol_table) const override;
 };
 
-class Boolean : virtual public Expression {
+class Boolean : public Expression {
 public:
   Boolean() = default;
   Boolean(const Boolean &other) = delete;
   Boolean &operator=(const Boolean &t) = delete;
-  virtual bool evalGetBool(const SymbolTable &symbol_table) const = 0;
-  virtual DataTypes getDataType(const SymbolTable &symbol_table) const override;
 };
 
 class Statement : public Node {
@@ -60,20 +200,71 @@ public:
   Statement() = default;
   Statement(const Statement &other) = delete;
   Statement &operator=(const Statement &t) = delete;
-  virtual std::string evalGetString(SymbolTable &symbol_table) const = 0;
+  /*add the instructions of the statement to the end of code*/
+  virtual void compile(Bytecode &code) const = 0;
 };
 
 class Program : Node {
 private:
-  std::vector<std::unique_ptr<Statement>> m_statements{};
+  /*an arena and the count of the memory it holds*/
+  struct Arena;
+
+  /*own the nodes of an arena program, empty when they are on the heap*/
+  std::vector<std::unique_ptr<Arena>> m_arenas{};
+  /*each debug info holds the statements from its start up to the start of the next*/
+  std::vector<std::unique_ptr<DebugInfo>> m_debug_infos{};
+  std::vector<std::size_t> m_debug_starts{};
+  std::vector<NodePtr<Statement>> m_statements{};
+  /*what eval runs, the statements are kept to print*/
+  std::unique_ptr<Bytecode> m_code;
+  /*the level every statement is optimized to, and whether any of them is*/
+  Optimization m_optimization{Optimization::none};
+  bool m_optimized{false};
+
+  const DebugInfo &getDebugInfo(std::size_t statement) const;
 
 public:
-  Program() = default;
+  explicit Program(NodeAllocation allocation = NodeAllocation::heap);
   Program(const Program &other) = delete;
   Program &operator=(const Program &t) = delete;
-  virtual std::string toString(const bool braces) const override;
-  void append(std::unique_ptr<Statement> &&s);
+  virtual ~Program() override;
+  using Node::toString;
+  virtual void print(std::string &out, const bool braces) const override;
+  /*write the text to out a few statements at a time so only those are held in memory*/
+  void print(std::ostream &out, const bool braces) const;
+  /*makes nodes where this program keeps them*/
+  NodeAllocator getAllocator() const;
+  void append(NodePtr<Statement> &&s);
+  /*
+  move every statement of other to the end of this program
+  with the arenas and debug info holding them
+  */
+  void append(Program &&other);
+  /*
+  optimize what eval runs up to level, worth it for a program run more than once, the output and
+  errors are unchanged
+  returns the number of instructions removed, a level the program already has does nothing
+  a program appended to keeps its level only if the one appended has it too
+  */
+  std::size_t optimize(Optimization level);
+  /*errors thrown are located in the source of the statement that threw them*/
   std::string eval(SymbolTable &symbol_table) const;
+  /*
+  append the output to out, false with the error located in fault if a statement fails
+  the statements before it have run
+  */
+  bool eval(SymbolTable &symbol_table, std::string &out, Fault &fault) const;
+  /*
+  bytes held by the arenas, debug info and bytecode, the nodes of a heap program are not counted
+  */
+  std::size_t getMemoryUsage() const;
+  /*
+  equal for programs with the same statements in the same order, see Expression::getFingerprint
+  the fingerprints of the subtrees of every statement are appended to subtrees
+  an optimized program has the fingerprint it had before it was optimized
+  */
+  Fingerprint getFingerprint(bool commutative = false,
+                             std::vector<Fingerprint> *subtrees = nullptr) const;
 };
 
 #endif
\ No newline at end of file
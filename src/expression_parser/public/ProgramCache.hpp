@@ -0,0 +1,76 @@
+#ifndef PROGRAM_CACHE_HPP
+#define PROGRAM_CACHE_HPP
+
+#include "Node.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief
+ * programs parsed from sources that are evaluated again and again, shared by every thread
+ * a source is looked up by its hash in one of several shards each with its own lock, so threads
+ * rarely wait on each other and a hit only takes a shared lock
+ * each shard evicts with the CLOCK algorithm once it holds its share of the memory budget,
+ * a hit only sets a flag where LRU would reorder a list under an exclusive lock
+ * programs are immutable once cached so one may be evaluated on many threads at once, each
+ * against its own symbol table, and an evicted program lives until its last user drops it
+ */
+class ProgramCache {
+public:
+  struct Stats {
+    std::uint64_t m_hits{};
+    std::uint64_t m_misses{};
+    std::uint64_t m_evictions{};
+    std::size_t m_programs{};
+    std::size_t m_bytes{};
+  };
+
+private:
+  struct Shard;
+
+  std::size_t m_shard_budget;
+  Optimization m_optimization;
+  std::vector<std::unique_ptr<Shard>> m_shards;
+  std::atomic<std::uint64_t> m_hits{0};
+  std::atomic<std::uint64_t> m_misses{0};
+  std::atomic<std::uint64_t> m_evictions{0};
+
+public:
+  /**
+   * @brief
+   * @param budget bytes of source and program kept, a program larger than the share of one shard
+   * is parsed but not kept
+   * @param shards
+   * @param optimization how much each program parsed is optimized, the levels above fold are
+   * left for callers to ask for
+   */
+  explicit ProgramCache(std::size_t budget = 64 << 20, std::size_t shards = 16,
+                        Optimization optimization = Optimization::fold);
+  ProgramCache(const ProgramCache &other) = delete;
+  ProgramCache &operator=(const ProgramCache &other) = delete;
+  ~ProgramCache();
+
+  /**
+   * @brief
+   * the program parsed from source with recursion_limit, parsed, optimized and kept on a miss
+   * null with the error in fault if the source does not parse, errors are not kept
+   * @param source
+   * @param recursion_limit
+   * @param fault
+   * @return std::shared_ptr<const Program>
+   */
+  std::shared_ptr<const Program> get(std::string_view source, std::uint32_t recursion_limit,
+                                     Fault &fault);
+  Stats getStats() const;
+  /*drop every program, the counters are kept*/
+  void clear();
+
+  /*the cache every Interpreter uses unless given another*/
+  static ProgramCache &getGlobal();
+};
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef RESULT_HPP
+#define RESULT_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <variant>
+
+/*what went wrong, each code is raised as one kind of error by the throwing API*/
+enum class ErrorCode : std::uint8_t {
+  none,
+  /*a character that starts no token, raised as LexicalError*/
+  lexical,
+  /*source that does not follow the grammar, raised as SyntaxError*/
+  syntax,
+  /*an operand of the wrong type found while parsing, raised as SyntaxError*/
+  static_type,
+  /*an assignment to pi e nan or inf, raised as SyntaxError*/
+  constant,
+  /*a variable used or assigned before it is created, raised as RuntimeError*/
+  unknown_variable,
+  /*a variable holding or assigned a value of the wrong type, raised as RuntimeError*/
+  wrong_type,
+  /*var for a variable that already exists, raised as RuntimeError*/
+  existing_variable,
+  /*an operation outside its domain such as x / 0 or log(-1), raised as RuntimeError*/
+  domain,
+};
+
+/**
+ * @brief
+ * an error returned instead of thrown
+ * holds what the thrown error would, the message is only formatted by getMessage
+ */
+class EvalError {
+private:
+  ErrorCode m_code;
+  /*a literal, the text of the error that is not one is kept in m_detail*/
+  std::string_view m_description;
+  std::string m_detail;
+  std::uint32_t m_line;
+  std::uint32_t m_postion;
+
+public:
+  EvalError(ErrorCode code, std::string_view description, std::string detail, std::uint32_t line,
+            std::uint32_t postion);
+
+  ErrorCode getCode() const;
+  std::string getDescription() const;
+  std::uint32_t getLine() const;
+  std::uint32_t getPostion() const;
+  /*the what() of the error the throwing API raises*/
+  std::string getMessage() const;
+};
+
+/*the output of a source or the error that stopped it, as std::expected would hold them*/
+class EvalResult {
+private:
+  std::variant<std::string, EvalError> m_value;
+
+public:
+  EvalResult(std::string output);
+  EvalResult(EvalError error);
+
+  bool hasValue() const;
+  explicit operator bool() const;
+  /*only when hasValue*/
+  const std::string &getValue() const;
+  /*only when not hasValue*/
+  const EvalError &getError() const;
+};
+
+#endif
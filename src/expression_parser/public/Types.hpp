@@ -1,7 +1,10 @@
 #ifndef TYPES_INTERNAL_HPP
 #define TYPES_INTERNAL_HPP
 
+#include <cstddef>
+#include <functional>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <variant>
 
@@ -11,6 +14,15 @@ enum class DataTypes {
 };
 
 using var = std::variant<bool, double>;
-using SymbolTable = std::unordered_map<std::string, var>;
+
+/*lets the symbol table be searched with any kind of string without copying it*/
+struct SymbolHash {
+  using is_transparent = void;
+  std::size_t operator()(std::string_view name) const noexcept {
+    return std::hash<std::string_view>{}(name);
+  }
+};
+
+using SymbolTable = std::unordered_map<std::string, var, SymbolHash, std::equal_to<>>;
 
 #endif
\ No newline at end of file
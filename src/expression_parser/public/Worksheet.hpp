@@ -0,0 +1,89 @@
+#ifndef WORKSHEET_HPP
+#define WORKSHEET_HPP
+
+#include "Node.hpp"
+#include "Result.hpp"
+#include "Types.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief
+ * a document edited line by line where each line holds its statements, the ; ending a line may
+ * be left out as in the calculator and blank lines are skipped
+ * only the edited lines are lexed and parsed again, every other line keeps its statements
+ * so the cost of an edit does not grow with the document
+ */
+class Worksheet {
+public:
+  /*a syntax error on a line, postion is the column of the last character of the bad token*/
+  struct Diagnostic {
+    std::size_t m_line{};
+    std::uint32_t m_postion{};
+    std::string m_message{};
+  };
+
+private:
+  struct Line {
+    std::string m_text{};
+    /*null for blank lines and lines with an error*/
+    std::unique_ptr<Program> m_program{};
+    bool m_has_error{false};
+    ErrorCode m_code{ErrorCode::none};
+    std::uint32_t m_postion{};
+    std::string m_message{};
+  };
+
+  std::vector<Line> m_lines{};
+  std::size_t m_error_count{};
+  std::uint32_t m_recursion_limit{default_recursion_limit};
+
+public:
+  Worksheet();
+  Worksheet(const Worksheet &) = delete;
+  Worksheet &operator=(const Worksheet &) = delete;
+
+  /**
+   * @brief
+   * replace count lines starting at first with lines and parse only those
+   * @param first
+   * @param count
+   * @param lines
+   */
+  void replaceLines(std::size_t first, std::size_t count, const std::vector<std::string> &lines);
+  /*replace the whole text, splitting it at new lines*/
+  void setText(std::string_view text);
+
+  std::size_t getLineCount() const;
+  std::size_t getErrorCount() const;
+  /*the statements of a line, null for blank lines and lines with an error*/
+  const Program *getProgram(std::size_t line) const;
+  /*the syntax errors on count lines from first*/
+  std::vector<Diagnostic> getDiagnostics(std::size_t first, std::size_t count) const;
+  std::vector<Diagnostic> getDiagnostics() const;
+  /**
+   * @brief
+   * the limit lines are parsed with, as Interpreter::setRecursionLimit, every line is parsed again
+   * so the whole worksheet keeps one limit
+   * @param limit
+   */
+  void setRecursionLimit(std::uint32_t limit);
+
+  /**
+   * @brief
+   * run every line in order, nothing runs if any line has a syntax error
+   * errors are thrown with their line in the worksheet
+   * @param symbol_table
+   * @return std::string
+   */
+  std::string eval(SymbolTable &symbol_table) const;
+
+private:
+  void parseLine(Line &line);
+};
+
+#endif
@@ -1,9 +1,7 @@
 #include "tokens.hpp"
+#include <algorithm>
 
-TokenData::TokenData(Token token, std::size_t postion, std::size_t line, std::string text)
-    : m_token(token), m_postion(postion), m_line(line), m_text(text) {}
-
-const std::string TokenData::getLocation() const {
+std::string SourceLocation::toString() const {
   std::string out{"Line: "};
   out.append(std::to_string(m_line));
   out.append(" Postion: ");
@@ -13,8 +11,24 @@ const std::string TokenData::getLocation() const {
 
 Token TokenData::getToken() const { return m_token; }
 
-const std::string TokenData::getText() const { return m_text; }
+std::uint32_t TokenData::getOffset() const { return m_offset; }
+
+std::uint32_t TokenData::getLength() const { return m_length; }
 
-std::size_t TokenData::getPostion() { return m_postion; }
+std::uint32_t TokenData::getLine() const { return m_line; }
 
-std::size_t TokenData::getLine() { return m_line; }
+std::string_view TokenData::getText(std::string_view source) const {
+  return source.substr(m_offset, m_length);
+}
+
+SourceLocation TokenData::getLocation(const std::vector<std::uint32_t> &line_starts,
+                                      const SourceLocation &origin) const {
+  // the end of input counts as a character for its postion
+  auto end{m_offset + std::max(m_length, std::uint32_t{1})};
+  auto postion{end - line_starts[m_line]};
+  // the first line continues a line of the whole source
+  if (m_line == 0) {
+    postion += origin.m_postion;
+  }
+  return {origin.m_line + m_line, postion};
+}
@@ -44,8 +44,8 @@ void gen() {
   for (std::size_t i = 0; i < 100; ++i) {
     ExpGen exp_gen{};
     auto val{exp_gen.getStatements()};
-    std::string input{val->toString(false)};
-    OUT << input << "\n";
+    val->print(OUT, false);
+    OUT << "\n";
   }
 }
 
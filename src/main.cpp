@@ -2,8 +2,43 @@
 #include <exception>
 #include <iostream>
 #include <string>
+#include <string_view>
 
-int main() {
+namespace {
+
+/**
+ * @brief
+ * run a whole script, - reads it from stdin
+ * @param path
+ * @return int exit code
+ */
+int runScript(const std::string &path) {
+  std::ios::sync_with_stdio(false);
+  Interpreter evaluator{};
+  try {
+    if (path == "-") {
+      evaluator.runStream(std::cin, std::cout);
+    } else {
+      evaluator.runFile(path, std::cout);
+    }
+  } catch (const std::exception &e) {
+    std::cout.flush();
+    std::cerr << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+
+  if (argc == 3 && std::string_view{argv[1]} == "--file") {
+    return runScript(argv[2]);
+  } else if (argc != 1) {
+    std::cerr << "usage: " << argv[0] << " [--file <path>|-]\n";
+    return 1;
+  }
 
   int return_value{0};
   std::string buffer{};
@@ -1,10 +1,20 @@
 
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 
+#include "ExpGen.hpp"
 #include "Interpreter.hpp"
+#include "ProgramCache.hpp"
+#include "Worksheet.hpp"
 #include <doctest/doctest.h>
 #include <exception>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
 
 TEST_SUITE("Expression Parser") {
   Interpreter interpreter{};
@@ -41,6 +51,75 @@ TEST_SUITE("Expression Parser") {
       CHECK(output == "6.6\n6\n3.3\n");
     }
   }
+  TEST_CASE("Source text") {
+    SUBCASE("string view") {
+      std::string_view input{"2 * 3; trailing text is not part of the view"};
+      auto output = interpreter.evaluate(input.substr(0, 6));
+      CHECK(output == "6\n");
+    }
+    SUBCASE("multiple lines") {
+      auto output = interpreter.evaluate("var line_a = 2;\n\tline_a ^ 3;\n");
+      CHECK(output == "8\n");
+    }
+    SUBCASE("identifiers close to keywords") {
+      auto output = interpreter.evaluate("var sine = 1; var Intx = 2; var o = 3; var not_ = 4;"
+                                         "sine + Intx + o + not_;");
+      CHECK(output == "10\n");
+    }
+    SUBCASE("bad character") {
+      CHECK_THROWS_AS(interpreter.evaluate("1 # 2;"), const std::exception &);
+    }
+    SUBCASE("location after long runs") {
+      std::string input(100, ' ');
+      input.append("var abcdefghijklmnopqrstuvwxyz_ABCDEFGHIJ_0123456789 = 1234567890123456789.5;");
+      input.append("\n\n \t\v  \r  1 + # ;");
+      try {
+        interpreter.evaluate(input);
+        CHECK(false);
+      } catch (const std::exception &e) {
+        CHECK(std::string{e.what()}.ends_with("Line: 2 Postion: 13"));
+      }
+    }
+    SUBCASE("syntax and runtime error locations") {
+      try {
+        interpreter.evaluate("1 +\n  (2 * 3;");
+        CHECK(false);
+      } catch (const std::exception &e) {
+        CHECK(std::string{e.what()}.ends_with("missing ) after subexpression Line: 1 Postion: 3"));
+      }
+      try {
+        interpreter.evaluate("var x_loc = 1;\nx_loc / 0;");
+        CHECK(false);
+      } catch (const std::exception &e) {
+        CHECK(std::string{e.what()}.ends_with("Bad divide operation Line: 1 Postion: 7"));
+      }
+    }
+    SUBCASE("out of range literal") {
+      std::string input(400, '9');
+      input.append(";");
+      try {
+        interpreter.evaluate(input);
+        CHECK(false);
+      } catch (const std::exception &e) {
+        CHECK(std::string{e.what()}.starts_with("Syntax Error"));
+      }
+      CHECK(interpreter.evaluate("0.5 + 00012.250;") == "12.75\n");
+    }
+    SUBCASE("syntax error before a bad character") {
+      try {
+        interpreter.evaluate("1 + ;\n#");
+        CHECK(false);
+      } catch (const std::exception &e) {
+        CHECK(std::string{e.what()}.starts_with("Syntax Error"));
+      }
+      try {
+        interpreter.evaluate("value #");
+        CHECK(false);
+      } catch (const std::exception &e) {
+        CHECK(std::string{e.what()}.starts_with("Lexing Error"));
+      }
+    }
+  }
   TEST_CASE("Unary") {
     SUBCASE("-1") {
       std::string input{"-1;"};
@@ -148,6 +227,11 @@ TEST_SUITE("Expression Parser") {
       auto output = interpreter.evaluate(input);
       CHECK(output == "2\n");
     }
+    SUBCASE("does not chain") {
+      CHECK_THROWS(interpreter.evaluate("2^3^2;"));
+      CHECK(interpreter.evaluate("(2^3)^2;") == "64\n");
+      CHECK(interpreter.evaluate("2^-1 * 4;") == "2\n");
+    }
   }
   TEST_CASE("Parentheses") {
     SUBCASE("1+(2*3)") {
@@ -315,5 +399,592 @@ TEST_SUITE("Expression Parser") {
       output = interpreter.evaluate(input);
       CHECK(output == "true\n");
     }
+    SUBCASE("precedence") {
+      CHECK(interpreter.evaluate("false and true or true;") == "true\n");
+      CHECK(interpreter.evaluate("true or true and false;") == "false\n");
+      CHECK(interpreter.evaluate("true and not 1 greater_than 2 or false;") == "true\n");
+      CHECK_THROWS(interpreter.evaluate("not not true;"));
+      CHECK_THROWS(interpreter.evaluate("1 + not true;"));
+      CHECK_THROWS(interpreter.evaluate("1 less_than 2 less_than 3;"));
+    }
+    SUBCASE("variables of either type") {
+      CHECK(interpreter.evaluate("var flag_v = true; var num_v = 2;").empty());
+      CHECK(interpreter.evaluate("not flag_v or num_v * num_v greater_than 3;") == "true\n");
+      CHECK(interpreter.evaluate("-num_v + sqrt(num_v * 2);") == "0\n");
+      CHECK_THROWS(interpreter.evaluate("not num_v;"));
+      CHECK_THROWS(interpreter.evaluate("flag_v + 1;"));
+    }
+  }
+  TEST_CASE("Scripts") {
+    const std::string script{"var script_a = 2;\n  script_a * 3; script_a\n;\n  script_a ^ 10;\n"};
+    SUBCASE("chunked stream") {
+      Interpreter runner{};
+      std::istringstream in{script};
+      std::ostringstream out{};
+      runner.runStream(in, out, 3);
+      CHECK(out.str() == "6\n2\n1024\n");
+    }
+    SUBCASE("error location across chunks") {
+      Interpreter runner{};
+      std::istringstream in{script + "\n  1 + \n (2 * script_a;"};
+      std::ostringstream out{};
+      try {
+        runner.runStream(in, out, 5);
+        CHECK(false);
+      } catch (const std::exception &e) {
+        CHECK(std::string{e.what()}.ends_with("missing ) after subexpression Line: 6 Postion: 2"));
+      }
+      CHECK(out.str() == "6\n2\n1024\n");
+    }
+    SUBCASE("file") {
+      const auto path{std::filesystem::temp_directory_path() / "expression_parser_script.expr"};
+      std::ofstream{path} << script << "script_a + 1";
+      Interpreter runner{};
+      std::ostringstream out{};
+      CHECK_THROWS_AS(runner.runFile(path.string(), out), const std::exception &);
+      CHECK(out.str() == "6\n2\n1024\n");
+      std::filesystem::remove(path);
+    }
+  }
+  TEST_CASE("Validation") {
+    SUBCASE("valid source is not run") {
+      Interpreter checker{};
+      CHECK_NOTHROW(checker.validate("var validated = (1 + 2) * 3 greater_than 4 or x; validated;"));
+      CHECK(!checker.getSymbolTable().contains("validated"));
+    }
+    SUBCASE("same first error as a full parse") {
+      for (std::string_view input :
+           {"1 +\n  (2 * 3;", "true + 1;", "not 1;", "sin(true);", "-false;", "1 and 2;",
+            "true less_than 2;", "var = 1;", "1 2;", "(1 + ;\n#", "value #"}) {
+        std::string expected{};
+        try {
+          Interpreter{}.evaluate(input);
+        } catch (const std::exception &e) {
+          expected = e.what();
+        }
+        std::string actual{};
+        try {
+          Interpreter{}.validate(input);
+        } catch (const std::exception &e) {
+          actual = e.what();
+        }
+        CHECK(!expected.empty());
+        CHECK(actual == expected);
+      }
+    }
+  }
+  TEST_CASE("Worksheet") {
+    Worksheet worksheet{};
+    worksheet.setText("var sheet_a = 2\n\nsheet_a * 3;\nsheet_a +");
+    CHECK(worksheet.getLineCount() == 4);
+    CHECK(worksheet.getErrorCount() == 1);
+    const Program *unchanged{worksheet.getProgram(2)};
+    SUBCASE("diagnostics follow inserted lines") {
+      worksheet.replaceLines(1, 0, {"1 # 2", "true"});
+      CHECK(worksheet.getErrorCount() == 2);
+      CHECK(worksheet.getProgram(4) == unchanged);
+      auto diagnostics{worksheet.getDiagnostics()};
+      REQUIRE(diagnostics.size() == 2);
+      CHECK(diagnostics[0].m_line == 1);
+      CHECK(diagnostics[0].m_postion == 3);
+      CHECK(diagnostics[1].m_line == 5);
+      CHECK(diagnostics[1].m_message == "invalid expression");
+    }
+    SUBCASE("evaluate after fixing a line") {
+      Interpreter runner{};
+      CHECK_THROWS_AS(runner.evaluate(worksheet), const std::exception &);
+      CHECK(!runner.getSymbolTable().contains("sheet_a"));
+      worksheet.replaceLines(3, 1, {"sheet_a + 1"});
+      CHECK(worksheet.getErrorCount() == 0);
+      CHECK(worksheet.getProgram(2) == unchanged);
+      CHECK(runner.evaluate(worksheet) == "6\n3\n");
+      worksheet.replaceLines(3, 1, {"sheet_a / 0"});
+      try {
+        Interpreter{}.evaluate(worksheet);
+        CHECK(false);
+      } catch (const std::exception &e) {
+        CHECK(std::string{e.what()}.ends_with("Bad divide operation Line: 3 Postion: 9"));
+      }
+    }
+  }
+  TEST_CASE("Fingerprint") {
+    const Interpreter interpreter{};
+    auto same = [&interpreter](std::string_view a, std::string_view b, bool commutative = false) {
+      return interpreter.getFingerprint(a, commutative) ==
+             interpreter.getFingerprint(b, commutative);
+    };
+    SUBCASE("whitespace, parentheses and literals are ignored") {
+      CHECK(same("1+2*x;", "  1 + (2 * ((x)))\n;"));
+      CHECK(same("var y = 1.0; y less_than 2;", "var y = (1);\n(y less_than 2.00);"));
+      CHECK(same("(true) and not (false);", "true and not false;"));
+    }
+    SUBCASE("structure is not") {
+      CHECK_FALSE(same("1 + 2 * 3;", "(1 + 2) * 3;"));
+      CHECK_FALSE(same("1 + 2;", "1 - 2;"));
+      CHECK_FALSE(same("x;", "y;"));
+      CHECK_FALSE(same("var x = 1;", "x = 1;"));
+      CHECK_FALSE(same("1; 2;", "2; 1;"));
+      CHECK_FALSE(same("1;", "1; 1;"));
+      CHECK_FALSE(same("a + b;", "b + a;"));
+    }
+    SUBCASE("commutative operands") {
+      CHECK(same("a + b * c;", "c * b + a;", true));
+      CHECK(same("x and (y or z);", "(z or y) and x;", true));
+      CHECK(same("a equal_to 1;", "1 equal_to a;", true));
+      CHECK_FALSE(same("a - b;", "b - a;", true));
+      CHECK_FALSE(same("a less_than b;", "b less_than a;", true));
+      CHECK_FALSE(same("a / b;", "b / a;", true));
+    }
+    SUBCASE("generated programs match their text") {
+      ExpGen exp_gen{};
+      const auto program{exp_gen.getStatements(20)};
+      CHECK(program->getFingerprint() == interpreter.getFingerprint(program->toString(true)));
+      CHECK(program->getFingerprint(true) ==
+            interpreter.getFingerprint(program->toString(true), true));
+      // the recursion limit does not change how statements are compiled or fingerprinted
+      Interpreter deep{};
+      deep.setRecursionLimit(0);
+      CHECK(deep.getFingerprint(program->toString(true)) == program->getFingerprint());
+      CHECK(deep.getFingerprint(program->toString(true), true) == program->getFingerprint(true));
+    }
+    SUBCASE("subtrees") {
+      ExpGen exp_gen{};
+      const auto expression{exp_gen.genArithmetic()};
+      std::vector<Fingerprint> subtrees{};
+      CHECK(expression->getFingerprint(false, &subtrees) == expression->getFingerprint());
+      REQUIRE_FALSE(subtrees.empty());
+      CHECK(subtrees.back() == expression->getFingerprint());
+    }
+    SUBCASE("errors are thrown") {
+      CHECK_THROWS(interpreter.getFingerprint("1 + ;"));
+      CHECK_THROWS(interpreter.getFingerprint("1 + true;"));
+    }
+  }
+  TEST_CASE("Printing") {
+    ExpGen exp_gen{};
+    const auto program{exp_gen.getStatements(50)};
+    for (const bool braces : {true, false}) {
+      std::ostringstream stream{};
+      program->print(stream, braces);
+      CHECK(stream.str() == program->toString(braces));
+      std::string out{"kept "};
+      program->print(out, braces);
+      CHECK(out == "kept " + program->toString(braces));
+    }
+    const auto expression{exp_gen.genBoolean()};
+    std::string out{};
+    expression->print(out, true);
+    CHECK(out == expression->toString(true));
+    CHECK(Interpreter{}.getFingerprint(program->toString(true)) == program->getFingerprint());
+  }
+  TEST_CASE("Parallel parse") {
+    std::string script{};
+    for (int i = 0; i < 4000; ++i) {
+      const auto name{"par_" + std::to_string(i)};
+      script.append("var " + name + " = " + std::to_string(i) + ";\n  " + name + " * 2; ");
+    }
+    script.append("\n\n");
+    SUBCASE("same output as a sequential parse") {
+      const auto expected{Interpreter{}.evaluate(script)};
+      CHECK(Interpreter{}.evaluate(script, 4) == expected);
+      CHECK(Interpreter{}.evaluate(script, 1) == expected);
+    }
+    SUBCASE("first error in source order") {
+      auto bad{script};
+      bad.insert(bad.size() - 100, "1 + # ;");
+      bad.insert(bad.size() / 2, "\n (1 + ;");
+      std::string expected{};
+      try {
+        Interpreter{}.evaluate(bad);
+      } catch (const std::exception &e) {
+        expected = e.what();
+      }
+      CHECK(expected.starts_with("Syntax Error"));
+      for (std::size_t threads : {2, 3, 8}) {
+        try {
+          Interpreter{}.evaluate(bad, threads);
+          CHECK(false);
+        } catch (const std::exception &e) {
+          CHECK(std::string{e.what()} == expected);
+        }
+      }
+    }
+    SUBCASE("runtime errors are located in the source of their piece") {
+      const auto bad{script + "par_10 / 0;"};
+      for (std::size_t threads : {1, 3, 8}) {
+        try {
+          Interpreter{}.evaluate(bad, threads);
+          CHECK(false);
+        } catch (const std::exception &e) {
+          CHECK(std::string{e.what()} ==
+                "Runtime Error\nBad divide operation Line: 4002 Postion: 8");
+        }
+      }
+    }
+  }
+
+  TEST_CASE("Arena") {
+    ExpGen exp_gen{NodeAllocation::arena};
+    auto program{exp_gen.getStatements(200)};
+    const auto source{program->toString(true)};
+    // generated programs may fail at runtime, the failure must match too, generated nodes have no
+    // location so the location is left out
+    auto run = [](auto &&eval) {
+      try {
+        return eval();
+      } catch (const std::exception &e) {
+        const std::string_view message{e.what()};
+        return std::string{message.substr(0, message.find(" Line:"))};
+      }
+    };
+    SymbolTable symbol_table{};
+    const auto expected{run([&] { return program->eval(symbol_table); })};
+    program.reset();
+    CHECK(run([&] { return Interpreter{}.evaluate(source); }) == expected);
+    CHECK(run([&] { return Interpreter{}.evaluate(source, 4); }) == expected);
+    SUBCASE("nodes made outside a program are on the heap") {
+      auto node{exp_gen.genArithmetic()};
+      CHECK_FALSE(node.get_deleter().m_in_arena);
+    }
+  }
+  TEST_CASE("Deep nesting") {
+    constexpr std::size_t depth{1000000};
+    auto repeat = [](std::string_view text, std::size_t count) {
+      std::string out{};
+      out.reserve(text.size() * count);
+      for (std::size_t i = 0; i < count; ++i) {
+        out.append(text);
+      }
+      return out;
+    };
+    Interpreter interpreter{};
+    SUBCASE("parentheses") {
+      const auto source{repeat("(", depth) + "1" + repeat(")", depth) + ";"};
+      CHECK(interpreter.evaluate(source) == "1\n");
+      CHECK_NOTHROW(interpreter.validate(source));
+      CHECK_THROWS(interpreter.evaluate(repeat("(", depth) + "1" + repeat(")", depth - 1) + ";"));
+    }
+    SUBCASE("unary operators") {
+      CHECK(interpreter.evaluate(repeat("-(", depth) + "1" + repeat(")", depth) + ";") == "1\n");
+      CHECK(interpreter.evaluate(repeat("not (", depth) + "true" + repeat(")", depth) + ";") ==
+            "true\n");
+    }
+    SUBCASE("right nested operators") {
+      CHECK(interpreter.evaluate(repeat("1+(", depth) + "1" + repeat(")", depth) + ";") ==
+            "1e+06\n");
+      CHECK(interpreter.evaluate(repeat("sin(", depth) + "0" + repeat(")", depth) + ";") ==
+            "0\n");
+    }
+    SUBCASE("left nested operators") {
+      const auto source{"var x = 0" + repeat("+1", depth) + "; x; x - 1 less_than x;"};
+      CHECK(interpreter.evaluate(source) == "1e+06\ntrue\n");
+      CHECK(Interpreter{}.evaluate(source, 2) == "1e+06\ntrue\n");
+    }
+    SUBCASE("fingerprints") {
+      CHECK(interpreter.getFingerprint(repeat("(", depth) + "1" + repeat(")", depth) + ";") ==
+            interpreter.getFingerprint("1;"));
+      CHECK(interpreter.getFingerprint(repeat("-(", depth) + "1" + repeat(")", depth) + ";") !=
+            interpreter.getFingerprint(repeat("-(", depth - 1) + "1" + repeat(")", depth - 1) +
+                                       ";"));
+    }
+    SUBCASE("heap allocated statements") {
+      Worksheet worksheet{};
+      worksheet.setText(repeat("-(", depth) + "1" + repeat(")", depth) + "\n" +
+                        repeat("(", depth) + "true)");
+      CHECK(worksheet.getErrorCount() == 1);
+      worksheet.setText(repeat("-(", depth) + "1" + repeat(")", depth));
+      CHECK(interpreter.evaluate(worksheet) == "1\n");
+      worksheet.replaceLines(1, 0, {"1 +", "2 * -(3 - 4)"});
+      worksheet.setRecursionLimit(0);
+      CHECK(worksheet.getErrorCount() == 1);
+      worksheet.replaceLines(1, 1, {});
+      CHECK(interpreter.evaluate(worksheet) == "1\n2\n");
+    }
+    SUBCASE("the limit only changes how statements run") {
+      ExpGen exp_gen{};
+      const auto source{exp_gen.getStatements(100)->toString(true)};
+      auto run = [&source](std::uint32_t limit) {
+        Interpreter interpreter{};
+        interpreter.setRecursionLimit(limit);
+        try {
+          return interpreter.evaluate(source);
+        } catch (const std::exception &e) {
+          return std::string{e.what()};
+        }
+      };
+      CHECK(run(0) == run(default_recursion_limit));
+    }
+  }
+  TEST_CASE("Errors without exceptions") {
+    Interpreter interpreter{};
+    SUBCASE("output of a valid source") {
+      const auto result{interpreter.tryEvaluate("var x = 2; x * 3; x less_than 1;")};
+      REQUIRE(result.hasValue());
+      CHECK(result.getValue() == "6\nfalse\n");
+    }
+    SUBCASE("same error as evaluate") {
+      const std::pair<std::string_view, ErrorCode> sources[]{
+          {"1 + #;", ErrorCode::lexical},
+          {"1 +\n  (2 * 3;", ErrorCode::syntax},
+          {"1 + true;", ErrorCode::static_type},
+          {"pi = 3;", ErrorCode::constant},
+          {"1 + y;", ErrorCode::unknown_variable},
+          {"var b = true; b = 1;", ErrorCode::wrong_type},
+          {"var c = 1; var c = 2;", ErrorCode::existing_variable},
+          {"var d = 1;\nlog(d - 2);", ErrorCode::domain},
+      };
+      for (const auto &[source, code] : sources) {
+        const auto result{Interpreter{}.tryEvaluate(source)};
+        REQUIRE_FALSE(result.hasValue());
+        CHECK(result.getError().getCode() == code);
+        try {
+          Interpreter{}.evaluate(source);
+          CHECK(false);
+        } catch (const std::exception &e) {
+          CHECK(result.getError().getMessage() == e.what());
+        }
+      }
+      const auto result{interpreter.tryEvaluate("var d = 1;\nlog(d - 2);")};
+      CHECK(result.getError().getDescription() == "Invalid argument to log");
+      CHECK(result.getError().getLine() == 1);
+      CHECK(result.getError().getPostion() == 3);
+    }
+    SUBCASE("statements before the error have run") {
+      CHECK_FALSE(interpreter.tryEvaluate("var a = 1; a / 0;").hasValue());
+      CHECK(interpreter.getSymbolTable().contains("a"));
+    }
+    SUBCASE("errors in deep statements") {
+      interpreter.setRecursionLimit(0);
+      const auto result{interpreter.tryEvaluate("1 + (2 * sqrt(0 - 1));")};
+      REQUIRE_FALSE(result.hasValue());
+      CHECK(result.getError().getCode() == ErrorCode::domain);
+      CHECK(result.getError().getMessage() ==
+            "Runtime Error\nInvalid argument to sqrt Line: 0 Postion: 13");
+      // the operands dropped by a syntax error are destroyed as deep ones
+      const auto dropped{interpreter.tryEvaluate("1 + (2 * -(3 - 4)) +;")};
+      REQUIRE_FALSE(dropped.hasValue());
+      CHECK(dropped.getError().getCode() == ErrorCode::syntax);
+    }
+  }
+  TEST_CASE("Compiled programs") {
+    Interpreter interpreter{};
+    SUBCASE("printed values") {
+      CHECK(interpreter.evaluate("1000000; 0.0001; 1 / 3; -0; 123456; 12.5; 1 less_than 2;") ==
+            "1e+06\n0.0001\n0.3333\n-0\n1.235e+05\n12.5\ntrue\n");
+    }
+    SUBCASE("a failing statement stops the program") {
+      CHECK_FALSE(interpreter.tryEvaluate("var n = 1; n = n + 1; n / 0; n = 5;").hasValue());
+      CHECK(std::get<double>(interpreter.getSymbolTable().at("n")) == 2);
+    }
+    SUBCASE("constants are refused before their value is evaluated") {
+      const auto result{interpreter.tryEvaluate("pi = undefined_variable;")};
+      REQUIRE_FALSE(result.hasValue());
+      CHECK(result.getError().getCode() == ErrorCode::constant);
+    }
+    SUBCASE("variables hold the type their operation uses") {
+      CHECK(interpreter.evaluate("var t = true; var u = 2; t; u; not t or u less_than 3;") ==
+            "true\n2\ntrue\n");
+      CHECK_THROWS(interpreter.evaluate("u and t;"));
+      CHECK_THROWS(interpreter.evaluate("t + u;"));
+    }
+    SUBCASE("many variables") {
+      std::string source{"var v0 = 1;"};
+      for (int i = 1; i < 100; ++i) {
+        source.append(" var v" + std::to_string(i) + " = v" + std::to_string(i - 1) + " + 1;");
+      }
+      source.append(" v99; v0 = v99;");
+      CHECK(interpreter.evaluate(source) == "100\n");
+      CHECK(std::get<double>(interpreter.getSymbolTable().at("v0")) == 100);
+      CHECK(std::get<double>(interpreter.getSymbolTable().at("v50")) == 51);
+    }
+  }
+  TEST_CASE("Optimization") {
+    SUBCASE("same output and errors as the program unoptimized") {
+      const std::string_view sources[]{
+          "sin(3.1) * 2.5 + Int(4.7); 2 ^ 10 % 7; 1 less_than 2 and not (3 equal_to 3);",
+          "var x = 2; x * 1; 1 * x; x - 0; x + -0; -0 + x; -(-x); + x; -(-(-x));",
+          "var b = true; not (not b); b and true; false or b; true and b or false;",
+          "var z = -0; z; z + 0; z - 0; z * 1; 0 - 0; -0 + -0;",
+          "var n = nan; n * 1; n - 0;",
+          "1 / 0;",
+          "log(0 - 1) * 1;",
+          "var i = inf; i / 1;",
+          "var w = true; w * 1;",
+          "var u = 1; u and true;",
+          "y * 1;",
+          "pi = 1 * 2;",
+          "var a = 3; var c = 4; sqrt(a * a + c * c); sqrt(a * a + c * c) * 2; a = 5;"
+          " sqrt(a * a + c * c); (a * a) + (a * a);",
+          "var k = 1; (k + 1) * (k + 1); k = k + 1; (k + 1) * (k + 1); var m = k + 1; m + (k + 1);",
+          "var q = 0; 2 + 1 / q; 2 + 1 / q;",
+          "var r = 2; log(r - 2) + log(r - 2); 1;",
+          "var s = 1; s less_than 2 and s less_than 2; not (s less_than 2) or s less_than 2;",
+          "var t = 1; t + 1; t = t + 1 + (t + 1); t + 1;",
+          "var v = 1.00011; v ^ 3 equal_to 1.0003300363013312; v ^ 3 greater_than"
+          " 1.000330036301331; v ^ 2 equal_to v * v; v ^ 5; v ^ 8; v ^ 2 / 4; v % 1;",
+          "var w = 512.92062593472724; (w ^ 2 - w * w) * 100000000000000000000; w ^ 2; w ^ 1;",
+          "var x = -1.5; x ^ 2; x ^ 3; x ^ 8; x ^ 0; x ^ 1; x ^ -0; x ^ 9; x ^ 2.5;",
+          "var g = nan; g ^ 0; 1 + g ^ 2;",
+          "var h = 1000000000000000000000000000000000000000; h ^ 4; h ^ 8;",
+          "var o = -0; o ^ 3; o ^ 2; o / 4; o % 2; 5 / o;",
+          "var d = 7; d / 4; d / -0.5; d / 3; -d % 4; d % -2; d % 0.5; d % 1; d % 0;",
+          "var f = inf; f / 2;",
+          "var j = inf; j % 4;",
+          "var l = 2.75; Int(Int(l)); Int(Int(l) * 2 - 1); Int(l ^ 2); Int(Int(l) ^ 2);"
+          " Int(l / 2);",
+      };
+      for (const auto level : {Optimization::fold, Optimization::reduce, Optimization::reuse}) {
+        ProgramCache cache{64 << 20, 16, level};
+        Interpreter optimized{};
+        optimized.setProgramCache(&cache);
+        Interpreter unoptimized{};
+        unoptimized.setProgramCache(nullptr);
+        for (const auto source : sources) {
+          const auto expected{unoptimized.tryEvaluate(source)};
+          const auto result{optimized.tryEvaluate(source)};
+          REQUIRE(result.hasValue() == expected.hasValue());
+          if (expected.hasValue()) {
+            CHECK(result.getValue() == expected.getValue());
+          } else {
+            CHECK(result.getError().getMessage() == expected.getError().getMessage());
+          }
+        }
+      }
+    }
+    SUBCASE("repeats are reused until their variables are stored to") {
+      Interpreter interpreter{};
+      CHECK(interpreter.evaluate("var a = 3; var c = 4; sqrt(a * a + c * c);") == "5\n");
+      CHECK(interpreter.evaluate("(a * a + c * c) + (a * a + c * c); a = 0; a * a + c * c;") ==
+            "50\n16\n");
+      CHECK(interpreter.evaluate("a = a + 1 + (a + 1); a + 1;") == "3\n");
+    }
+    SUBCASE("generated programs") {
+      ExpGen exp_gen{};
+      auto program{exp_gen.getStatements(50)};
+      const auto text{program->toString(true)};
+      const auto fingerprint{program->getFingerprint(true)};
+      auto run = [&program] {
+        SymbolTable symbol_table{};
+        try {
+          return program->eval(symbol_table);
+        } catch (const std::exception &e) {
+          return std::string{e.what()};
+        }
+      };
+      const auto expected{run()};
+      for (const auto level : {Optimization::fold, Optimization::reduce, Optimization::reuse}) {
+        program->optimize(level);
+        CHECK(program->optimize(level) == 0);
+        CHECK(run() == expected);
+        CHECK(program->toString(true) == text);
+        CHECK(program->getFingerprint(true) == fingerprint);
+      }
+    }
+  }
+  TEST_CASE("Optimization after append") {
+    ExpGen exp_gen{};
+    auto program{exp_gen.getStatements(50)};
+    auto rest{exp_gen.getStatements(50)};
+    const auto text{program->toString(true) + rest->toString(true)};
+    Interpreter interpreter{};
+    interpreter.setProgramCache(nullptr);
+    const auto expected{interpreter.tryEvaluate(text)};
+    const auto fingerprint{interpreter.getFingerprint(text, true)};
+    auto run = [&program] {
+      SymbolTable symbol_table{};
+      try {
+        return std::make_pair(true, program->eval(symbol_table));
+      } catch (const std::exception &e) {
+        return std::make_pair(false, std::string{e.what()});
+      }
+    };
+    program->optimize(Optimization::reuse);
+    program->append(std::move(*rest));
+    for (std::size_t i = 0; i < 2; ++i) {
+      const auto [ran, output] = run();
+      REQUIRE(ran == expected.hasValue());
+      if (ran) {
+        CHECK(output == expected.getValue());
+      }
+      CHECK(program->getFingerprint(true) == fingerprint);
+      // the appended statements are optimized, those optimized before are left as they were
+      program->optimize(Optimization::reuse);
+    }
+  }
+  TEST_CASE("Program cache") {
+    ProgramCache cache{};
+    auto make = [&cache] {
+      Interpreter interpreter{};
+      interpreter.setProgramCache(&cache);
+      return interpreter;
+    };
+    SUBCASE("hits share the parsed program") {
+      auto interpreter{make()};
+      CHECK(interpreter.evaluate("var x = 2;") == "");
+      CHECK(interpreter.evaluate("x * 3;") == "6\n");
+      CHECK(interpreter.evaluate("x = x + 1;") == "");
+      CHECK(interpreter.evaluate("x * 3;") == "9\n");
+      CHECK(make().evaluate("1 + 2;") == "3\n");
+      CHECK(make().evaluate("1 + 2;") == "3\n");
+      const auto stats{cache.getStats()};
+      CHECK(stats.m_hits == 2);
+      CHECK(stats.m_misses == 4);
+      CHECK(stats.m_programs == 4);
+      CHECK(stats.m_bytes > 0);
+    }
+    SUBCASE("errors are not kept") {
+      CHECK_THROWS(make().evaluate("1 + ;"));
+      CHECK_FALSE(make().tryEvaluate("1 + ;").hasValue());
+      CHECK(make().tryEvaluate("1 + y;").getError().getCode() == ErrorCode::unknown_variable);
+      CHECK(make().tryEvaluate("1 + y;").getError().getCode() == ErrorCode::unknown_variable);
+      const auto stats{cache.getStats()};
+      CHECK(stats.m_misses == 3);
+      CHECK(stats.m_hits == 1);
+      CHECK(stats.m_programs == 1);
+    }
+    SUBCASE("evicts within its budget") {
+      ProgramCache small{4096, 1};
+      Interpreter interpreter{};
+      interpreter.setProgramCache(&small);
+      for (int i = 0; i < 200; ++i) {
+        CHECK(interpreter.evaluate(std::to_string(i) + " + 1;") == std::to_string(i + 1) + "\n");
+      }
+      const auto stats{small.getStats()};
+      CHECK(stats.m_evictions > 0);
+      CHECK(stats.m_programs < 200);
+      CHECK(stats.m_bytes <= 4096);
+      small.clear();
+      CHECK(small.getStats().m_programs == 0);
+    }
+    SUBCASE("evaluated on several threads") {
+      ExpGen exp_gen{};
+      const auto source{exp_gen.getStatements(50)->toString(true)};
+      auto run = [&source](ProgramCache *shared) {
+        Interpreter interpreter{};
+        interpreter.setProgramCache(shared);
+        try {
+          return interpreter.evaluate(source);
+        } catch (const std::exception &e) {
+          return std::string{e.what()};
+        }
+      };
+      const auto expected{run(nullptr)};
+      std::vector<std::string> results(4);
+      std::vector<std::thread> threads{};
+      for (auto &result : results) {
+        threads.emplace_back([&] {
+          for (int i = 0; i < 20; ++i) {
+            result = run(&cache);
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      for (const auto &result : results) {
+        CHECK(result == expected);
+      }
+      CHECK(cache.getStats().m_hits + cache.getStats().m_misses == 80);
+    }
   }
-}
\ No newline at end of file
+}